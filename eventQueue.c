@@ -0,0 +1,61 @@
+/*------------------------------------------------------------------------------
+ * File:        eventQueue.c
+ * Description: Lock-free single-producer/single-consumer ring of input events.
+ *              The producer only writes head, the consumer only writes tail,
+ *              both are 8-bit so every index store is a single instruction and
+ *              neither side ever has to disable interrupts.
+ *----------------------------------------------------------------------------*/
+
+#include "eventQueue.h"
+
+
+void eventReset(EventQueue* q)
+{
+    q->head = 0;
+    q->tail = 0;
+    q->overflow = 0;
+    q->highWater = 0;
+
+    return;
+}
+
+
+char eventPush(EventQueue* q, const InputEvent* e)
+{
+    // Producer side, one caller at a time (ADC12ISR, or the benchmark while it owns the queue) - no interrupt disabling needed
+    unsigned char head = q->head;
+    unsigned char used = (head - q->tail) & (EVENT_QUEUE_SIZE - 1);
+
+    if (used == EVENT_QUEUE_SIZE - 1)                               // one slot is kept empty to tell full from empty
+    {
+        q->overflow++;
+        return 0;
+    }
+
+    q->buf[head] = *e;                                              // fill the slot first...
+    q->head = (head + 1) & (EVENT_QUEUE_SIZE - 1);                  // ...then publish it (single 8-bit store)
+
+    if (used + 1 > q->highWater)
+    {
+        q->highWater = used + 1;
+    }
+
+    return 1;
+}
+
+
+char eventPop(EventQueue* q, InputEvent* e)
+{
+    // Consumer side, only ever called from the game loop
+    unsigned char tail = q->tail;
+
+    if (tail == q->head)                                            // nothing waiting
+    {
+        return 0;
+    }
+
+    *e = q->buf[tail];                                              // copy the slot out first (volatile, so not hoisted above the check)...
+    q->tail = (tail + 1) & (EVENT_QUEUE_SIZE - 1);                  // ...then hand it back to the producer
+
+    return 1;
+}
@@ -0,0 +1,37 @@
+/* Input Event Queue - single-producer (ADC12ISR) / single-consumer (game loop) ring buffer */
+/* No hardware access in here, so the same code builds for the board and for the host tests */
+
+/* Producer Contract - there is exactly one producer at any time. Normally that is ADC12ISR;
+*  the benchmark takes the role over from the game loop by setting benchRunning first, which
+*  keeps ADC12ISR off the queue until it is cleared again. Nothing else may call eventPush.
+*/
+
+#ifndef EVENTQUEUE_H
+#define EVENTQUEUE_H
+
+#define EVENT_QUEUE_SIZE 16                                 // ring size (power of 2, index math is a mask)
+
+
+// One event per change of a stick's panel mask: rest -> mask is a press, mask -> 0 a release
+typedef struct
+{
+    unsigned int time;                                      // value: ADC sample tick the edge was seen on
+    unsigned char player;                                   // value: player index the edge belongs to
+    unsigned char mask;                                     // mask: panels now held (STEP_* bits), 0 = back at rest
+} InputEvent;
+
+typedef struct
+{
+    volatile InputEvent buf[EVENT_QUEUE_SIZE];              // ring storage (volatile so slot copies stay ordered around the indexes)
+    volatile unsigned char head;                            // index: next slot to write (only the producer writes this)
+    volatile unsigned char tail;                            // index: next slot to read (only the consumer writes this)
+    volatile unsigned int overflow;                         // counter: events dropped because the ring was full
+    volatile unsigned char highWater;                       // counter: most events ever waiting at once
+} EventQueue;
+
+
+void eventReset(EventQueue* q);                             // empty the ring and clear its counters (nobody else may be using it)
+char eventPush(EventQueue* q, const InputEvent* e);         // producer side: 1 = queued, 0 = full (counted in overflow)
+char eventPop(EventQueue* q, InputEvent* e);                // consumer side: 1 = got one, 0 = empty
+
+#endif
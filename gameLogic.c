@@ -0,0 +1,269 @@
+/*------------------------------------------------------------------------------
+ * File:        gameLogic.c
+ * Description: Beat judgment for every player sharing one event queue. Each
+ *              event only ever touches the player it belongs to, so two
+ *              interleaved input traces are judged exactly as if each player
+ *              were playing alone, and a beat closes on the clock so an idle
+ *              player can never hold up the other one. The stick classifier
+ *              lives here too so the input zones can be tested on the host,
+ *              as can the calibration statistics.
+ *----------------------------------------------------------------------------*/
+
+#include "gameLogic.h"
+
+
+unsigned char stickClassify(unsigned int x, unsigned int y, unsigned char prev)
+{
+    /* Panel Mask Values - each axis sets at most one bit, so diagonals come out as two-bit masks
+    *
+    *          U+L   U   U+R
+    *           L    +    R
+    *          D+L   D   D+R
+    *
+    * Single panels use the original zones: 15% or less / 85% or more on one axis with the
+    * other axis held inside 35-65%. Diagonals need both axes at least 25% away from center
+    * and roughly at 45 degrees (the smaller deflection at least 2/3 of the larger one, i.e.
+    * 34-56 degrees). Growing a held single panel into a diagonal also needs the new axis as
+    * far out as a single-panel press (15% / 85%), so an UP push that drifts sideways stays UP.
+    *
+    * Anything outside these zones and the 40-60% center box is a gap, and gaps are handled
+    * per axis: a panel that is already held stays held while its axis is still on that side
+    * of the center box, but no new panel is ever added. A held diagonal only loses a panel
+    * when that axis comes back to center or the stick reaches a single panel's own zone,
+    * so wobbling around a corner can't bounce between U and U+L.
+    *
+    * Thresholds are compared in raw ADC counts so that no float math is needed per sample.
+    */
+
+    unsigned int dx = (x >= ADC_PER(50)) ? x - ADC_PER(50) : ADC_PER(50) - x;      // deflection from center, per axis
+    unsigned int dy = (y >= ADC_PER(50)) ? y - ADC_PER(50) : ADC_PER(50) - y;      //
+    unsigned int small = (dx < dy) ? dx : dy;
+    unsigned int large = (dx < dy) ? dy : dx;
+    unsigned char keep = 0;                                         // mask: held panels whose axis is still on their side
+    unsigned char mask;
+
+    // CENTER
+    if ((x <= ADC_PER(60) && x >= ADC_PER(40)) && (y <= ADC_PER(60) && y >= ADC_PER(40)))
+    {
+        return 0;
+    }
+
+    if ((prev & STEP_L) && x < ADC_PER(40))
+    {
+        keep |= STEP_L;
+    }
+    if ((prev & STEP_R) && x > ADC_PER(60))
+    {
+        keep |= STEP_R;
+    }
+    if ((prev & STEP_U) && y < ADC_PER(40))
+    {
+        keep |= STEP_U;
+    }
+    if ((prev & STEP_D) && y > ADC_PER(60))
+    {
+        keep |= STEP_D;
+    }
+
+    // DIAGONALS: one bit from each axis
+    if (small >= ADC_PER(25) && 3 * small >= 2 * large)
+    {
+        mask = ((x < ADC_PER(50)) ? STEP_L : STEP_R) | ((y < ADC_PER(50)) ? STEP_U : STEP_D);
+
+        if (keep == 0 ||                                            // coming from rest: the corner zone is enough
+            (!((mask & ~keep & (STEP_L | STEP_R)) && dx < ADC_PER(35)) &&
+             !((mask & ~keep & (STEP_U | STEP_D)) && dy < ADC_PER(35))))
+        {
+            return mask;                                            // growing a held panel: the new axis is all the way out
+        }
+    }
+
+    // SINGLE PANELS
+    if (y >= ADC_PER(35) && y <= ADC_PER(65))
+    {
+        if (x <= ADC_PER(15))
+        {
+            return STEP_L;
+        }
+        if (x >= ADC_PER(85))
+        {
+            return STEP_R;
+        }
+    }
+    if (x >= ADC_PER(35) && x <= ADC_PER(65))
+    {
+        if (y <= ADC_PER(15))
+        {
+            return STEP_U;
+        }
+        if (y >= ADC_PER(85))
+        {
+            return STEP_D;
+        }
+    }
+
+    // GAP: only what was already held survives
+    return keep;
+}
+
+
+char judgeBegin(Player* players, unsigned char numPlayers)
+{
+    char pending = 0;                                               // bitmask of players still waiting on a direction
+    int i;
+
+    for (i = 0; i < numPlayers; i++)
+    {
+        if (players[i].endSong == 'p')                              // knocked-out players sit the beat out
+        {
+            pending |= (1 << i);
+            players[i].beats++;
+        }
+        players[i].result = '_';
+        players[i].chord = 0;
+    }
+
+    return pending;
+}
+
+
+char judgeEvent(Player* players, char* pending, const InputEvent* e,
+                unsigned char step, unsigned int beatTick, int judgeOffset)
+{
+    Player* p = &players[e->player];
+
+    if (!(*pending & (1 << e->player)))                             // already judged this beat (or not playing)
+    {
+        return 0;
+    }
+
+    if (e->mask != 0)
+    {
+        if (p->chord == 0)                                          // first panel down starts the clock
+        {
+            if ((int)(e->time - beatTick) - judgeOffset < -JUDGE_WINDOW)
+            {
+                return 0;                                           // pressed before the window opened: left over from an earlier beat
+            }
+            p->pressTime = e->time;
+        }
+        p->chord |= e->mask;
+
+        if (p->chord != step && (p->chord & ~step) == 0)            // only part of a jump so far, wait for the rest
+        {
+            return 0;
+        }
+    }
+    else if (p->chord == 0)                                         // let go of something held from before this beat
+    {
+        return 0;
+    }
+
+    int late = (int)(p->pressTime - beatTick) - judgeOffset;        // response time with the calibrated delay taken out
+
+    // Right panels, wrong time still misses (too late = pressed after the window had closed)
+    if (late < -JUDGE_WINDOW || judgeExpired(p->pressTime, beatTick, judgeOffset))
+    {
+        p->chord = 0;
+    }
+
+    judgeStep(p, p->chord, step);
+    *pending &= ~(1 << e->player);
+
+    return 1;
+}
+
+
+char judgeExpired(unsigned int now, unsigned int beatTick, int judgeOffset)
+{
+    // Same clock as judgeEvent: once a press stamped now would be too late, nothing pending can still hit.
+    // A large offset can't push the close past JUDGE_CLOSE, or the next beat's frame wouldn't be ready in time
+    int since = (int)(now - beatTick);
+
+    return since - judgeOffset > JUDGE_WINDOW || since >= JUDGE_CLOSE;
+}
+
+
+void judgeClose(Player* players, char* pending, unsigned char step)
+{
+    int i;
+
+    for (i = 0; *pending; i++)
+    {
+        if (*pending & (1 << i))
+        {
+            judgeStep(&players[i], 0, step);                        // never finished a chord in time: miss
+            *pending &= ~(1 << i);
+        }
+    }
+
+    return;
+}
+
+
+void calibStats(unsigned int* samples, unsigned char n, unsigned int* median, unsigned int* spread)
+{
+    // Sorts the samples in place (insertion sort, n is tiny) then reads off the median and IQR
+    unsigned char i, j;
+
+    for (i = 1; i < n; i++)
+    {
+        unsigned int v = samples[i];
+
+        for (j = i; j > 0 && samples[j - 1] > v; j--)
+        {
+            samples[j] = samples[j - 1];
+        }
+        samples[j] = v;
+    }
+
+    *median = (n & 1) ? samples[n / 2] : samples[n / 2 - 1] + (samples[n / 2] - samples[n / 2 - 1]) / 2;
+    *spread = samples[(3 * n) / 4] - samples[n / 4];
+
+    return;
+}
+
+
+char judgeStep(Player* p, unsigned char mask, unsigned char step)
+{
+    // Pure per-player judgment: only touches the player passed in, so two input traces never interfere
+    if (mask == step)                                               // if exactly the right panels were hit
+    {
+        p->result = 'h';
+    }
+    else                                                            // if incorrect/no direction chosen
+    {
+        p->result = 'm';
+        p->strike++;                                                // increase strike counter
+
+        if (p->strike >= 3)
+        {
+            p->endSong = 'l';                                       // send bad ending flag
+        }
+    }
+
+    return p->result;
+}
+
+
+char judgeWinner(const Player* players)
+{
+    // Surviving the song beats being knocked out, lasting longer beats going out early, strikes only break a tie
+    const Player* a = &players[0];
+    const Player* b = &players[1];
+
+    if ((a->endSong == 'w') != (b->endSong == 'w'))
+    {
+        return (a->endSong == 'w') ? 0 : 1;
+    }
+    if (a->endSong == 'l' && a->beats != b->beats)                  // both knocked out
+    {
+        return (a->beats > b->beats) ? 0 : 1;
+    }
+    if (a->strike != b->strike)
+    {
+        return (a->strike < b->strike) ? 0 : 1;
+    }
+
+    return -1;
+}
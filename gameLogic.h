@@ -0,0 +1,58 @@
+/* Game Logic - per-player judgment of a beat, fed one input event at a time */
+/* No hardware access in here, so the same code builds for the board and for the host tests */
+
+#ifndef GAMELOGIC_H
+#define GAMELOGIC_H
+
+#include "eventQueue.h"
+
+/* Step Encoding - one byte per beat, a 4-bit mask of the panels to hit (DDR order L D U R).
+*  Single arrows set one bit, jumps/diagonals set two (with one stick only neighbouring
+*  panels like STEP_U | STEP_L can be reached at once). A step is never 0.
+*/
+
+#define STEP_L 0x01
+#define STEP_D 0x02
+#define STEP_U 0x04
+#define STEP_R 0x08
+
+#define ADC_PER(p) ((unsigned int)((p) * 4095L / 100))      // percentage of stick travel -> raw 12-bit ADC count
+#define JUDGE_WINDOW 5                                      // judgment: samples either side of the corrected beat that still count
+#define BEAT_SAMPLES 10                                     // ADC bursts (0.1s) per WDT beat (1s)
+#define JUDGE_CLOSE (BEAT_SAMPLES - 2)                      // judgment: samples after the beat by which every window has closed,
+                                                            //   so the result and the next frame get the last 0.1-0.2s of the beat
+#define JUDGE_OFFSET_MAX (JUDGE_CLOSE - 1)                  // calibration: largest offset that still leaves the corrected beat judgeable
+
+
+// Player State
+typedef struct
+{
+    unsigned char stickState;                               // mask - ISR side: last classified panels, 0 = at rest
+    unsigned char held;                                     // mask - game loop side: panels currently held, 0 = at rest
+    unsigned char chord;                                    // mask - panels pressed so far on this beat (builds up jumps)
+    unsigned int pressTime;                                 // value: sample tick the first panel of the chord went down
+    unsigned short int strike;                              // counter: penalty counter
+    unsigned int beats;                                     // counter: beats played, stops on the beat a player is knocked out
+    char endSong;                                           // flag: p = song in-progress, w = end of song win, l = end of song lose
+    char result;                                            // flag - last beat: h = hit, m = miss, _ = not judged yet
+} Player;
+
+
+unsigned char stickClassify(unsigned int x, unsigned int y, unsigned char prev);
+                                                            // raw stick reading -> panel mask, prev = mask from the last sample
+char judgeBegin(Player* players, unsigned char numPlayers); // open a beat: clears results/chords, returns the pending player mask
+char judgeEvent(Player* players, char* pending, const InputEvent* e,
+                unsigned char step, unsigned int beatTick, int judgeOffset);
+                                                            // route one event to its player: 1 = that player's beat got judged
+char judgeExpired(unsigned int now, unsigned int beatTick, int judgeOffset);
+                                                            // 1 = the beat's window has closed at sample tick now
+void judgeClose(Player* players, char* pending, unsigned char step);
+                                                            // window closed: every player still pending misses
+char judgeStep(Player* p, unsigned char mask, unsigned char step);
+                                                            // hit/miss a finished chord, updates strikes and the lose flag
+char judgeWinner(const Player* players);                    // versus result: 0 = player 1, 1 = player 2, -1 = draw
+
+void calibStats(unsigned int* samples, unsigned char n, unsigned int* median, unsigned int* spread);
+                                                            // sorts samples (n >= 1) and returns their median and IQR
+
+#endif
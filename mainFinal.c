@@ -12,8 +12,12 @@
 
 // Preprocessor Directives
 #include <msp430xG46x.h>
-#include "soundtrack.h"                                             // header file containing arrays of all 4 songs and their names
+#include "soundtrack.h"                                             // header file containing the song library, its charts and names
 #include "symbols.h"                                                // header file for all string used
+#include "eventQueue.h"                                             // input event ring between ADC12ISR and the game loop
+#include "gameLogic.h"                                              // player state and per-event beat judgment
+#include "wire.h"                                                   // run-length wire encoding of everything sent to the terminal
+#include "symbolsWire.h"                                            // symbols.h assets already wire-encoded, sent as-is
 
 #define SET_GREEN() P2OUT |= BIT2;                                  // LED settings
 #define RESET_GREEN() P2OUT &= ~BIT2;                               //
@@ -25,18 +29,101 @@
 #define SET_BUZZER() P3SEL |= BIT5;                                 // buzzer settings
 #define RESET_BUZZER() P3SEL &= ~BIT5;                              //
 
+#ifndef BENCHMARK_MODE                                              // build with BENCHMARK_MODE=1 to run the benchmark at power-up
+#define BENCHMARK_MODE 0                                            //
+#endif                                                              //
+#ifndef PIPELINED_OUTPUT                                            // build with PIPELINED_OUTPUT=0 for the old in-ISR render
+#define PIPELINED_OUTPUT 1                                          // (same latency stamps, to compare the two on hardware)
+#endif                                                              //
+
+
+#define MAX_PLAYERS 2                                               // versus mode: two thumbsticks on one board
+
+#define SONGS_PER_PAGE 4                                            // song browser: entries shown at once
+#define MENU_ENTRY_ROW 10                                           // song browser: terminal row of the first entry
+#define MENU_PAGE_ROW 15                                            // song browser: terminal row of the page indicator
+#define MENU_END_ROW 18                                             // song browser: first row after the menu
+#define HOLD_TICKS 10                                               // song browser: samples (0.1s each) that count as a hold
+
+#define FRAME_SIZE 640                                              // beat frame: clear + up to four arrow glyphs (two rows of two)
+#define TIMERA_PERIOD 3277                                          // Timer A ticks between ADC bursts (continuous mode, CCR0 steps on by this)
+
+#define BENCH_START_NPS 1                                           // benchmark: first tempo tried, notes per second
+#define BENCH_MAX_NPS 60                                            // benchmark: give up ramping past this tempo
+#define BENCH_BEATS 8                                               // benchmark: beats played at each tempo step
+
+#define STAGE_PREPARE 0                                             // beat pipeline stages, blamed when a beat overruns
+#define STAGE_OUTPUT 1                                              //
+#define STAGE_JUDGE 2                                               //
+
+#define CALIB_BEATS 12                                              // calibration: metronome beats collected
+#define CALIB_FLASH ((const Calibration*) 0x1000)                   // calibration: info memory segment B, survives power cycles
+#define CALIB_MAGIC 0xCA1B                                          // calibration: marks the segment as holding a saved offset
+#define DEFAULT_OFFSET 4                                            // judgment: offset (samples) used until a calibration is saved
+
+
+// Saved Calibration (lives in info flash)
+typedef struct
+{
+    unsigned int magic;                                             // value: CALIB_MAGIC once written, 0xFFFF when erased
+    int offset;                                                     // value: median beat -> response delay, in samples
+    unsigned int spread;                                            // value: interquartile range of that delay, in samples
+} Calibration;
+
+
+// Beat Output Frame (built ahead of time, sent by the UART TX interrupt)
+typedef struct
+{
+    char bytes[FRAME_SIZE];                                         // everything the terminal gets for this beat
+    unsigned int length;                                            // value: bytes used
+    unsigned int tone;                                              // value: TB0CCR0 setting for the buzzer
+} Frame;
+
 
 // Global Variables and Constants
-volatile long int ADCx, ADCy;                                       // value: intermediate values taken from joy-stick
-volatile float Xper, Yper;                                          // value: voltage percentages
-volatile unsigned short int strike = 0;                             // counter: penalty counter
-volatile unsigned int songIter = 0;                                 // counter: song iteration counter
+Player players[MAX_PLAYERS];                                        // per-player state, index 0 is always player 1
+unsigned char numPlayers = 1;                                       // counter: number of players in the current game (1 or 2)
+volatile unsigned int songIter = 0;                                 // counter: song iteration counter (shared chart position)
+
+EventQueue inputQueue;                                              // direction edges from the sticks, consumed by the game loop
+volatile unsigned int sampleTick = 0;                               // counter: ADC bursts taken (timestamp for input events)
+
+const unsigned char* songPtr = 0;                                   // pointer for song selection (currently pointed to NULL)
+unsigned int songLen = 0;                                           // value: currently selected song length
 
-char* songPtr = 0;                                                  // pointer for song selection (currently pointed to NULL)
-int* songLenPtr = 0;                                                // pointer for currently selected song length
+unsigned int browsePage = 0;                                        // index: song browser page, kept across visits
+unsigned char browseRow = 0;                                        // index: highlighted entry on that page
 
 char arrowSent = 0;                                                 // flag - arrow sent: 0 - arrow in-progress, 1 - arrow sent
-char endSong = 'p';                                                 // flag: p = song in-progress, w = end of song win, l = end of song lose
+
+Frame frames[2];                                                    // double buffer: one being sent, one being built
+Frame* frameBack = &frames[0];                                      // pointer: frame the game loop is building
+Frame* frameFront = &frames[1];                                     // pointer: frame the TX interrupt is sending
+volatile char frameReady = 0;                                       // flag - back frame complete and waiting for the beat
+volatile char frameSending = 0;                                     // flag - TX interrupt still draining the front frame
+volatile unsigned int txIndex = 0;                                  // index: next front frame byte to send
+unsigned int frameIter = 0;                                         // index: beat the old in-ISR path builds (PIPELINED_OUTPUT 0)
+
+volatile unsigned long beatStamp = 0;                               // value: timerA_now() when the last beat fired
+volatile unsigned int beatTick = 0;                                 // value: sampleTick when the last beat fired
+int judgeOffset = DEFAULT_OFFSET;                                   // value: samples subtracted from every response before judging
+volatile unsigned int latencyFirst = 0;                             // value: beat -> first frame byte, Timer A ticks (30.5us)
+volatile unsigned int latencyLast = 0;                              // value: beat -> last frame byte entering the shift register
+                                                                    //        (its 10 bits still take ~87us to be fully on the wire)
+volatile unsigned int latencyFirstMax = 0;                          // value: worst beat -> first byte seen
+volatile unsigned int latencyLastMax = 0;                           // value: worst beat -> last byte seen
+
+const char* const panelGlyph[4] = { left, down, up, right };       // arrow art per panel bit, STEP_L first
+const char* const panelWire[4] = { leftWire, downWire, upWire, rightWire }; // same art, already wire-encoded
+const unsigned int panelTone[4] = { 37, 99, 16, 75 };               // TB0CCR0 per panel bit: idk freq 1, muy low, high, idk freq 2
+
+volatile char benchRunning = 0;                                     // flag - benchmark owns the input queue, ADC12ISR stays off it
+volatile unsigned int benchSlot = 0;                                // value: Timer A ticks between benchmark beats (CCR1)
+
+volatile unsigned int timerAOverflow = 0;                           // counter: Timer A wraps, high half of the 32-bit clock
+volatile char loopStage = STAGE_PREPARE;                            // value: what the main loop is busy with (STAGE_*)
+volatile unsigned int beatOverruns = 0;                             // counter: beats that fired before the pipeline could take them
+volatile signed char overrunStage = -1;                             // value: stage blamed for the first overrun, -1 = none yet
 
 
 
@@ -48,21 +135,49 @@ void setupUART(void);                                               //
 void setupBuzzer(void);                                             //
 void setupTimerB(void);                                             //
 void setupLEDs(void);                                               //
+void setupInput(void);                                              //
+void setupCalibration(void);                                        //
 //void setupSPI(void);                                                //
 
 void UART_putCharacter(char c);                                     // UART/SPI shit
-void UART_sendString(char* string);                                 //
+void UART_sendString(const char* string);                           //
+void UART_sendRaw(const char* wire);                                //
+void UART_sendColumns(const char* leftStr, const char* rightStr);   //
+void UART_sendNumber(unsigned long n);                              //
+void UART_moveCursor(unsigned char row);                            //
 //void SPI_setState(unsigned char State);                             //
 
-void titleSequence(void);                                           // game-related functions
-char directSelect(void);                                            //
-void selectConfirm(char* string);                                   //
+char modeSelect(void);                                              // game-related functions
+void titleSequence(void);                                           //
+void drawEntry(unsigned char row);                                  //
+void drawPage(void);                                                //
+void stickSample(unsigned char player, unsigned int x, unsigned int y); //
+char pollEvent(InputEvent* e);                                      //
+void waitEvent(InputEvent* e);                                      //
+unsigned char directSelect(void);                                   //
+void selectConfirm(const char* string);                             //
 void clearScreen(void);                                             //
 void restingState(void);                                            //
 void endSongCondition(void);                                        //
 char playAgain(void);                                               //
-void arrowOutput(int iter);                                         //
+void benchmark(void);                                               //
+void calibrate(void);                                               //
+void calibSave(int offset, unsigned int spread);                    //
+void arrowPrepare(unsigned int iter);                               //
+void frameBuild(Frame* f, unsigned int iter);                       //
+void frameKick(void);                                               //
+void frameAppend(Frame* f, const char* string);                     //
+void frameAppendRaw(Frame* f, const char* wire);                    //
+void frameAppendColumns(Frame* f, const char* leftStr, const char* rightStr); //
+unsigned int timerA_read(void);                                     //
+unsigned long timerA_now(void);                                     //
+unsigned long timerA_since(unsigned long stamp);                    //
+void beatFire(void);                                                //
+void beatOverrun(char stage);                                       //
+void latencyRecord(char last);                                      //
 void directConfirm(void);                                           //
+void resetPlayers(void);                                            //
+char songInProgress(void);                                          //
 void resetLEDs(void);                                               //
 
 
@@ -78,34 +193,62 @@ void main(void)
     setupBuzzer();                                                  // Setup buzzer
     setupTimerB();                                                  // Setup timer for buzzer shit
     setupLEDs();                                                    // Setup LEDs
+    setupInput();                                                   // Setup stick states and input event queue
+    setupCalibration();                                             // Load the saved judgment offset
     //setupSPI();                                                   // Setup SPI connection for red LED
 
+    resetPlayers();                                                 // start everyone with a clean slate
     _EINT();                                                        // enable global interrupts
 
+#if BENCHMARK_MODE
+    benchmark();                                                    // headline throughput number before anything else
+#endif
+
     // Gameplay Loop
     char play = 'y';                                                // play again flag
     while (play == 'y')
     {
         RESET_BUZZER();                                             // make sure the buzzer is off to begin with
+        char mode = modeSelect();
+        if (mode == 'B')                                            // benchmark picked instead of a game
+        {
+            benchmark();
+            continue;
+        }
+        if (mode == 'C')                                            // calibration picked instead of a game
+        {
+            calibrate();
+            continue;
+        }
+        numPlayers = mode - '0';
         titleSequence();
         clearScreen();
 
 
         // Song Loop
-        while (endSong == 'p')
+        while (songInProgress())
         {
-            if (songIter == *songLenPtr)                            // If end-of-song reached
+            if (songIter == songLen)                                // If end-of-song reached
             {
-                endSong = 'w';                                      // send win flag
+                int i;
+                for (i = 0; i < numPlayers; i++)
+                {
+                    if (players[i].endSong == 'p')
+                    {
+                        players[i].endSong = 'w';                   // send win flag to everyone still standing
+                    }
+                }
                 break;
             }
 
+            loopStage = STAGE_PREPARE;
+            arrowPrepare(songIter);                                 // use the idle time to build this beat's frame
             IE1 |= WDTIE;                                           // turn on WDT interrupt
             while (arrowSent == 0);                                 // wait for arrow to be sent
             arrowSent = 0;                                          // reset sent arrow flag to False
 
-            restingState();                                         // makes sure player has reset their thumbstick direction
-            directConfirm();                                        // determines if player gets the point or not
+            loopStage = STAGE_JUDGE;
+            directConfirm();                                        // determines if player gets the point or not (a stick held over needs a fresh push)
             RESET_BUZZER();                                         // turn off buzzer
             songIter++;                                             // every second iterate to the next song
         }
@@ -119,8 +262,7 @@ void main(void)
 
         // Reset Game Conditions
         songIter = 0;                                               // reset next direction in song array iterator
-        strike = 0;                                                 // reset strike counter
-        endSong = 'p';                                              // reset flag
+        resetPlayers();                                             // reset strike counters and flags
 
         play = playAgain();                                         // play again sequence
     }
@@ -137,11 +279,24 @@ void main(void)
 #pragma vector = ADC12_VECTOR
 __interrupt void ADC12ISR(void)
 {
-    ADCx = ADC12MEM0;                                               // Move results, IFG is cleared
-    ADCy = ADC12MEM1;
+    unsigned int x1 = ADC12MEM0;                                    // Move results, IFG is cleared
+    unsigned int y1 = ADC12MEM1;
+    unsigned int x2 = ADC12MEM2;                                    // second stick comes in on the same burst
+    unsigned int y2 = ADC12MEM3;
+
+    sampleTick++;
+
+    if (benchRunning)                                               // scripted inputs only while benchmarking
+    {
+        __bic_SR_register_on_exit(LPM0_bits);
+        return;
+    }
 
-    Xper = (ADCx * 3.0/4095 * 100/3);                               // Calculate percentage outputs
-    Yper = (ADCy * 3.0/4095 * 100/3);
+    stickSample(0, x1, y1);                                         // only direction changes get queued
+    if (numPlayers == 2)                                            // a floating second stick would just spam the queue
+    {
+        stickSample(1, x2, y2);
+    }
 
     __bic_SR_register_on_exit(LPM0_bits);                           // Exit LPM0
 
@@ -154,6 +309,7 @@ __interrupt void ADC12ISR(void)
 __interrupt void timerA_isr()
 {
     // Control Register Getting New Values from Joystick
+    TACCR0 += TIMERA_PERIOD;                                        // next burst 0.1s on (the timer itself never stops)
     ADC12CTL0 |= ADC12SC;                                           // Start conversions
     __bis_SR_register(LPM0_bits + GIE);                             // Enter LPM0
 
@@ -161,6 +317,37 @@ __interrupt void timerA_isr()
 }
 
 
+// Timer A CCR1 / Overflow
+#pragma vector = TIMERA1_VECTOR
+__interrupt void timerA1_isr(void)
+{
+    switch (TAIV)
+    {
+        // CCR1: benchmark beat clock
+        case 2:
+            TACCR1 += benchSlot;
+            beatFire();
+
+            while ((unsigned int)(timerA_read() - TACCR1) < 0x8000)           // next beat already went by while this one was being sent
+            {
+                TACCR1 += benchSlot;
+                beatOverrun(STAGE_OUTPUT);
+            }
+            break;
+
+        // TAR wrapped
+        case 10:
+            timerAOverflow++;
+            break;
+
+        default:
+            break;
+    }
+
+    return;
+}
+
+
 // WDT
 #pragma vector = WDT_VECTOR
 __interrupt void WDT_ISR()
@@ -178,9 +365,32 @@ __interrupt void WDT_ISR()
 //
 //    count = 0;
 
-    arrowOutput(songIter);                                          // output correct song
-    SET_BUZZER();                                                   // turn on buzzer
-    arrowSent = 1;                                                  // arrow sent flag to True
+    beatFire();                                                     // the song's beat
+
+    return;
+}
+
+
+// UART TX
+#pragma vector = USCIAB0TX_VECTOR
+__interrupt void USCIA0TX_ISR(void)
+{
+    if (txIndex < frameFront->length)                               // next byte of the beat frame
+    {
+        UCA0TXBUF = frameFront->bytes[txIndex++];
+
+        if (txIndex == 1)                                           // first byte is on its way
+        {
+            latencyRecord(0);
+        }
+
+        return;
+    }
+
+    IE2 &= ~UCA0TXIE;                                               // whole frame handed to the shift register
+    frameSending = 0;
+
+    latencyRecord(1);
 
     return;
 }
@@ -202,9 +412,10 @@ void setupWDT()
 
 void setupTimerA(void)
 {
-    TACCR0 = 3277;                                  // 3277 / 32768 Hz = 0.1s
-    TACTL = TASSEL_1 + MC_1;                        // ACLK, up mode
+    TACCR0 = TIMERA_PERIOD;                         // 3277 / 32768 Hz = 0.1s, moved on by timerA_isr
+    TACTL = TASSEL_1 + MC_2 + TAIE;                 // ACLK, continuous mode (free-running clock), overflow interrupt
     TACCTL0 = CCIE;                                 // Enabled interrupt
+    TACCTL1 = 0;                                    // CCR1 only runs during the benchmark
 
     return;
 }
@@ -212,16 +423,18 @@ void setupTimerA(void)
 
 void setupADC(void)
 {
-    P6DIR &= ~BIT3 + ~BIT7;                         // Configure P6.3 and P6.7 as input pins
-    P6SEL |= BIT3 + BIT7;                           // Configure P6.3 and P6.7 as analog pins
+    P6DIR &= ~(BIT3 + BIT7 + BIT4 + BIT5);          // Configure P6.3, P6.7, P6.4 and P6.5 as input pins
+    P6SEL |= BIT3 + BIT7 + BIT4 + BIT5;             // Configure P6.3, P6.7, P6.4 and P6.5 as analog pins
 
     ADC12CTL0 = ADC12ON + SHT0_6 + MSC;             // configure ADC converter
     ADC12CTL1 = SHP + CONSEQ_1;                     // Use sample timer, single sequence
 
-    ADC12MCTL0 = INCH_3;                            // ADC A3 pin - Stick X-axis
-    ADC12MCTL1 = INCH_7 + EOS;                      // ADC A7 pin - Stick Y-axis
+    ADC12MCTL0 = INCH_3;                            // ADC A3 pin - Player 1 Stick X-axis
+    ADC12MCTL1 = INCH_7;                            // ADC A7 pin - Player 1 Stick Y-axis
+    ADC12MCTL2 = INCH_4;                            // ADC A4 pin - Player 2 Stick X-axis
+    ADC12MCTL3 = INCH_5 + EOS;                      // ADC A5 pin - Player 2 Stick Y-axis
                                                     // EOS - End of Sequence for Conversions
-    ADC12IE |= 0x02;                                // Enable ADC12IFG.1
+    ADC12IE |= 0x08;                                // Enable ADC12IFG.3 (last of the burst)
 
     int i = 0;
     for (i = 0; i < 0x3600; i++);                   // Delay for reference start-up
@@ -286,6 +499,51 @@ void setupLEDs(void)
 }
 
 
+void setupInput(void)
+{
+    int i;
+    for (i = 0; i < MAX_PLAYERS; i++)
+    {
+        players[i].stickState = 0;                  // sticks start at rest
+        players[i].held = 0;
+    }
+
+    eventReset(&inputQueue);                        // empty ring
+
+    return;
+}
+
+
+void setupCalibration(void)
+{
+    if (CALIB_FLASH->magic == CALIB_MAGIC)          // use the saved offset, otherwise keep the default
+    {
+        judgeOffset = CALIB_FLASH->offset;
+        if (judgeOffset < 0 || judgeOffset > JUDGE_OFFSET_MAX)  // saved before the clamp existed
+        {
+            judgeOffset = (judgeOffset < 0) ? 0 : JUDGE_OFFSET_MAX;
+        }
+    }
+
+    return;
+}
+
+
+void resetPlayers(void)
+{
+    int i;
+    for (i = 0; i < MAX_PLAYERS; i++)
+    {
+        players[i].strike = 0;                      // reset strike counter
+        players[i].beats = 0;                       // reset beats played
+        players[i].endSong = 'p';                   // reset flag
+        players[i].result = '_';                    // nothing judged yet
+    }
+
+    return;
+}
+
+
 void resetLEDs(void)
 {
     RESET_GREEN();
@@ -317,6 +575,7 @@ void resetLEDs(void)
 // UART/SPI Functions -------------------
 void UART_putCharacter(char c)
 {
+    while (frameSending);                           // let the beat frame finish first
     while(!(IFG2 & UCA0TXIFG));                     // Wait for previous character to be sent
     UCA0TXBUF = c;                                  // Send byte to the buffer for transmitting
 
@@ -324,18 +583,84 @@ void UART_putCharacter(char c)
 }
 
 
-void UART_sendString(char* string)
+void UART_sendString(const char* string)
 {
-    int i;
-    for (i = 0; string[i] != 0; i++)                // iterates through all characters in string and sends em
+    char token[WIRE_TOKEN_MAX];
+    unsigned int used;
+    unsigned char len, i;
+
+    while (*string != 0)                            // iterates through the string a run at a time and sends the shortest form
+    {
+        len = wireToken(string, &used, token);
+        for (i = 0; i < len; i++)
+        {
+            UART_putCharacter(token[i]);
+        }
+        string += used;
+    }
+
+    return;
+}
+
+
+void UART_sendRaw(const char* wire)
+{
+    // For symbolsWire.h strings: already encoded, so they go out byte for byte
+    while (*wire != 0)
+    {
+        UART_putCharacter(*wire++);
+    }
+
+    return;
+}
+
+
+void UART_sendColumns(const char* leftStr, const char* rightStr)
+{
+    // Prints two (possibly multi-line) strings next to each other, one line at a time
+    char line[LINE_SIZE + 1];
+
+    while (*leftStr != 0 || *rightStr != 0)
     {
-        UART_putCharacter(string[i]);
+        columnLine(&leftStr, &rightStr, line);
+        UART_sendString(line);
+        UART_sendString(lineReset);
+    }
+
+    return;
+}
+
+
+void UART_sendNumber(unsigned long n)
+{
+    char digits[10];                                // 4294967295 is the most a long can hold
+    int i = 0;
+
+    do                                              // peel off digits least significant first
+    {
+        digits[i++] = '0' + (n % 10);
+        n /= 10;
+    } while (n != 0);
+
+    while (i > 0)                                   // and send them back in order
+    {
+        UART_putCharacter(digits[--i]);
     }
 
     return;
 }
 
 
+void UART_moveCursor(unsigned char row)
+{
+    UART_sendString("\033[");                      // CUP - cursor to (row, column 1)
+    UART_sendNumber(row);
+    UART_sendString(";1H");
+
+    return;
+}
+
+
 //void SPI_setState(unsigned char State)
 //{
 //    while(P3IN & 0x01);                             // verifies busy flag
@@ -350,79 +675,37 @@ void UART_sendString(char* string)
 
 
 // Game Functions -------------------
-void titleSequence(void)
+char modeSelect(void)
 {
-    clearScreen();
-
-    // Title
-    UART_sendString(lineReset);
-    UART_sendString(bar);
-    UART_sendString(lineReset);
-    UART_sendString(lineReset);
-    UART_sendString(title);
-    UART_sendString(lineReset);
-    UART_sendString(lineReset);
-    UART_sendString(bar);
-    UART_sendString(lineReset);
-
-    // Song Choosing Instruction
-    UART_sendString(lineReset);
-    UART_sendString(chooseInstr);
-    UART_sendString(lineReset);
-
-    // Song Decision Plus
-    UART_sendString(lineReset);
-    UART_sendString(songChoice1);
-    UART_sendString(lineReset);
-    UART_sendString(songChoice2);
-    UART_sendString(lineReset);
-    UART_sendString(songChoice3);
-    UART_sendString(lineReset);
-
-    // Ending Bar
-    UART_sendString(lineReset);
-    UART_sendString(bar);
-    UART_sendString(lineReset);
+    UART_sendRaw(menuWire);                                 // clear + whole menu, encoded ahead of time
 
+    numPlayers = 1;                                         // only player 1 picks the mode
     restingState();
 
 
-    // Direction Selection
-    while (1)                                               // infinite loop in case no direction is output
+    while (1)
     {
-        char dir = directSelect();
+        unsigned char mask = directSelect();
 
-        switch(dir)
+        switch (mask)
         {
-            // UP: song #1
-            case 'U':
-                songPtr = song1;
-                songLenPtr = &song1Len;
-                selectConfirm(song1Name);
-                return;
+            // UP: Calibration
+            case STEP_U:
+                return 'C';
 
-            // DOWN: song #4
-            case 'D':
-                songPtr = song4;
-                songLenPtr = &song4Len;
-                selectConfirm(song4Name);
-                return;
+            // LEFT: 1 Player
+            case STEP_L:
+                return '1';
 
-            // LEFT: song #2
-            case 'L':
-                songPtr = song2;
-                songLenPtr = &song2Len;
-                selectConfirm(song2Name);
-                return;
+            // RIGHT: 2 Players (versus)
+            case STEP_R:
+                return '2';
 
-            // RIGHT: song #3
-            case 'R':
-                songPtr = song3;
-                songLenPtr = &song3Len;
-                selectConfirm(song3Name);
-                return;
+            // DOWN: Benchmark
+            case STEP_D:
+                return 'B';
 
-            default:                                        // do nothing if no direction is output
+            default:
                 break;
         }
     }
@@ -430,115 +713,655 @@ void titleSequence(void)
 }
 
 
-char directSelect(void)
+void benchmark(void)
 {
-    /* Button Configuration Values
-    *
-    *              U
-    *          L   +   R
-    *              D
+    /* Plays the synthetic chart with scripted inputs, stepping the tempo up until the beat pipeline
+    *  (prepare -> output -> judge) can no longer keep up. Beats are fired by Timer A CCR1 every
+    *  32768 / notes-per-second ticks, exactly like the WDT fires them in a song; a beat that fires
+    *  while the last frame is still going out, or before the next one is built, is an overrun and
+    *  is blamed on whatever stage the pipeline was in at the time.
     */
 
-    while (1)                                                       // loop until direction is chosen
+    const char* stageName[3] = { "prepare", "output", "judge" };
+    const char* assetName[] = { "bar", "title", "chooseInstr", "calibChoice", "modeChoice", "benchChoice",
+                                "up", "down", "left", "right", "correct", "miss" };
+    const char* assetData[] = { bar, title, chooseInstr, calibChoice, modeChoice, benchChoice,
+                                up, down, left, right, correct, miss };
+    unsigned int nps;
+    unsigned int bestNps = 0;
+    unsigned long worstBeat = 0;
+    unsigned int overrunNps = 0;
+    InputEvent e;
+    int i;
+
+    benchRunning = 1;                                       // ADC12ISR stops producing, we are the only producer now
+    latencyFirstMax = 0;                                    // worst-case output latency over this run only
+    latencyLastMax = 0;
+    beatOverruns = 0;
+    overrunStage = -1;
+    songPtr = benchChart;
+    songLen = sizeof(benchChart);
+    e.player = 0;
+
+    for (nps = BENCH_START_NPS; nps <= BENCH_MAX_NPS && beatOverruns == 0; nps++)
     {
-        // UP
-        if ((Xper >= 35.0 && Xper <= 65.0) && (Yper >= 0.0 && Yper <= 15.0))
+        benchSlot = 32768U / nps;
+        songIter = 0;
+        arrowSent = 0;
+
+        loopStage = STAGE_PREPARE;
+        arrowPrepare(songIter);                             // first beat is built before the clock starts
+        TACCR1 = timerA_read() + benchSlot;
+        TACCTL1 = CCIE;                                     // start the beat clock
+
+        for (i = 0; i < BENCH_BEATS; i++)
         {
-            return 'U';
+            unsigned long stamp, t;
+
+            while (arrowSent == 0);                         // wait for the beat, same as the song loop
+            arrowSent = 0;
+            stamp = beatStamp;                              // frameReady is 0 now, so no beat can rewrite it until arrowPrepare
+
+            // Judge - release whatever was held, then hit (even beats) or miss (odd beats)
+            loopStage = STAGE_JUDGE;
+            resetPlayers();                                 // no knock-outs mid-benchmark
+            if (players[0].held != 0)
+            {
+                e.time = beatTick;
+                e.mask = 0;
+                eventPush(&inputQueue, &e);
+            }
+            e.time = beatTick + judgeOffset;               // right on the (corrected) beat
+            e.mask = (i & 1) ? songPtr[(songIter + 1) % songLen] : songPtr[songIter];
+            eventPush(&inputQueue, &e);
+
+            restingState();
+            directConfirm();
+            RESET_BUZZER();
+
+            // Prepare the next beat
+            loopStage = STAGE_PREPARE;
+            songIter = (songIter + 1) % songLen;
+            arrowPrepare(songIter);                         // the last one is built too, the clock is still running
+
+            t = timerA_since(stamp);                        // beat fired -> pipeline ready for the next one
+            if (t > worstBeat)
+            {
+                worstBeat = t;
+            }
         }
 
-        // DOWN
-        if ((Xper >= 35.0 && Xper <= 65.0) && (Yper >= 85.0 && Yper <= 100.0))
+        TACCTL1 = 0;                                        // stop the beat clock
+        while (frameSending);
+        frameReady = 0;
+
+        if (beatOverruns == 0)
+        {
+            bestNps = nps;
+        }
+        else
         {
-            return 'D';
+            overrunNps = nps;
         }
+    }
+
+    // Give the sticks back to ADC12ISR, matching the game loop's view to the real stick
+    players[0].held = players[0].stickState;
+    songIter = 0;
+    resetPlayers();
+    resetLEDs();
+    benchRunning = 0;
+
+
+    // Report
+    clearScreen();
+    UART_sendString(lineReset);
+    UART_sendRaw(barWire);
+    UART_sendString(lineReset);
+    UART_sendString(lineReset);
+    UART_sendString(" Benchmark Results");
+    UART_sendString(lineReset);
+    UART_sendString(lineReset);
+    UART_sendString(" Max sustainable tempo:  ");
+    UART_sendNumber(bestNps);
+    UART_sendString(" notes/sec");
+    UART_sendString(lineReset);
+    UART_sendString(" Worst beat processing:  ");
+    UART_sendNumber(worstBeat * 15625 / 512);               // ticks -> microseconds (1e6 / 32768)
+    UART_sendString(" us");
+    UART_sendString(lineReset);
+    UART_sendString(" Output path:            ");
+    UART_sendString(PIPELINED_OUTPUT ? "pipelined (TX interrupt)" : "in-ISR (PIPELINED_OUTPUT=0)");
+    UART_sendString(lineReset);
+    UART_sendString(" Beat -> first byte:     ");
+    UART_sendNumber(latencyFirstMax * 15625UL / 512);
+    UART_sendString(" us");
+    UART_sendString(lineReset);
+    UART_sendString(" Beat -> last byte:      ");
+    UART_sendNumber(latencyLastMax * 15625UL / 512);
+    UART_sendString(" us");
+    UART_sendString(lineReset);
+    UART_sendString(" Input queue dropped:    ");          // since power-up, ADC12ISR's and the benchmark's
+    UART_sendNumber(inputQueue.overflow);
+    UART_sendString(" events");
+    UART_sendString(lineReset);
+    UART_sendString(" Input queue peak:       ");
+    UART_sendNumber(inputQueue.highWater);
+    UART_sendString(" of ");
+    UART_sendNumber(EVENT_QUEUE_SIZE - 1);
+    UART_sendString(" slots");
+    UART_sendString(lineReset);
+    if (beatOverruns != 0)
+    {
+        UART_sendString(" First overrun:          ");
+        UART_sendString(stageName[(int)overrunStage]);
+        UART_sendString(" stage at ");
+        UART_sendNumber(overrunNps);
+        UART_sendString(" notes/sec");
+    }
+    else
+    {
+        UART_sendString(" No overrun up to ");
+        UART_sendNumber(BENCH_MAX_NPS);
+        UART_sendString(" notes/sec");
+    }
+    UART_sendString(lineReset);
+    UART_sendString(lineReset);
 
-        // LEFT
-        if ((Xper >= 0.0 && Xper <= 15.0) && (Yper >= 35.0 && Yper <= 65.0))
+    // Wire compression - raw bytes vs what the encoder actually sends, per asset
+    UART_sendString(" Wire bytes per asset (raw -> sent)");
+    UART_sendString(lineReset);
+    for (i = 0; i < (int)(sizeof(assetName) / sizeof(assetName[0])); i++)
+    {
+        unsigned int raw = 0;
+        int col;
+
+        while (assetData[i][raw] != 0)
         {
-            return 'L';
+            raw++;
         }
 
-        // RIGHT
-        if ((Xper >= 85.0 && Xper <= 100.0) && (Yper >= 35.0 && Yper <= 65.0))
+        UART_putCharacter(' ');
+        UART_sendString(assetName[i]);
+        for (col = 1; assetName[i][col - 1] != 0; col++);
+        for (; col < 16; col++)
         {
-            return 'R';
+            UART_putCharacter(' ');
         }
 
-//        // CENTER - error handling
-//        if ((Xper <= 60.0 && Xper >= 40.0) && (Yper <= 60.0 && Yper >= 40.0))
-//        {
-//            return '_';
-//        }
+        UART_sendNumber(raw);
+        UART_sendString(" -> ");
+        UART_sendNumber(wireLength(assetData[i]));
+        UART_sendString(" bytes");
+        UART_sendString(lineReset);
     }
+    UART_sendString(lineReset);
+    UART_sendString(" Push any direction to go back");
+    UART_sendString(lineReset);
+    UART_sendString(lineReset);
+    UART_sendRaw(barWire);
+    UART_sendString(lineReset);
 
+    restingState();
+    directSelect();
+
+    return;
 }
 
 
-void selectConfirm(char* string)
+void calibrate(void)
 {
+    /* Plays a steady metronome (same arrow + click every WDT beat) and times how long after each
+    *  beat the player's press shows up. The median of those delays becomes the judgment offset,
+    *  which covers UART render time, the 0.1s ADC sampling and the terminal/player's own lag.
+    */
+
+    unsigned int samples[CALIB_BEATS];
+    unsigned int median, spread;
+    InputEvent e;
+    unsigned char n;
+
+    clearScreen();
     UART_sendString(lineReset);
-    UART_sendString(bar);
+    UART_sendRaw(barWire);
     UART_sendString(lineReset);
     UART_sendString(lineReset);
-    UART_sendString(" Is \"");
-    UART_sendString(string);
-    UART_sendString("\" your selection?");
+    UART_sendString(" Calibration: push the stick the moment each arrow/click shows up");
     UART_sendString(lineReset);
     UART_sendString(lineReset);
-    UART_sendString("    Yes   +   No    ");
+    UART_sendString(" Push any direction to start");
     UART_sendString(lineReset);
     UART_sendString(lineReset);
-    UART_sendString(bar);
+    UART_sendRaw(barWire);
     UART_sendString(lineReset);
 
-
     restingState();
+    directSelect();
 
+    songPtr = calibChart;
 
-    while (1)                                           // infinite loop in case L or R direction is not used
+    for (n = 0; n < CALIB_BEATS; n++)
     {
-        char dir = directSelect();
+        arrowPrepare(0);
+        IE1 |= WDTIE;                                       // metronome runs off the same beat as a song
+        while (arrowSent == 0);
+        arrowSent = 0;
 
-        switch (dir)
+        restingState();
+        do                                                  // any direction counts, only the timing matters
         {
-            // LEFT: Yes
-            case 'L':
-                return;                                  // break out of song confirmation, song selection, and title sequence
+            waitEvent(&e);
+        } while (e.player != 0 || e.mask == 0);
 
-            // RIGHT: No
-            case 'R':
-                clearScreen();                          // clear screen
-                titleSequence();                        // replay title sequence again
-                return;
+        int delay = (int)(e.time - beatTick);
+        samples[n] = (delay > 0) ? delay : 0;               // jumping the gun counts as dead on
+        RESET_BUZZER();
+    }
 
-            default:                                    // any other direction does nothing
-                break;
-        }
+    IE1 &= ~WDTIE;
+    RESET_BUZZER();
+
+    calibStats(samples, CALIB_BEATS, &median, &spread);
+    if (median > JUDGE_OFFSET_MAX)                          // a slower median would keep the window open into the next beat
+    {
+        median = JUDGE_OFFSET_MAX;
     }
+    judgeOffset = median;
+    calibSave(median, spread);
 
-}
 
+    // Report
+    clearScreen();
+    UART_sendString(lineReset);
+    UART_sendRaw(barWire);
+    UART_sendString(lineReset);
+    UART_sendString(lineReset);
+    UART_sendString(" Calibration Saved");
+    UART_sendString(lineReset);
+    UART_sendString(lineReset);
+    UART_sendString(" Median offset:  ");
+    UART_sendNumber(median * 100UL);                        // samples -> ms
+    UART_sendString(" ms");
+    UART_sendString(lineReset);
+    UART_sendString(" Spread (IQR):   ");
+    UART_sendNumber(spread * 100UL);
+    UART_sendString(" ms");
+    UART_sendString(lineReset);
+    UART_sendString(lineReset);
+    UART_sendString(" Push any direction to go back");
+    UART_sendString(lineReset);
+    UART_sendString(lineReset);
+    UART_sendRaw(barWire);
+    UART_sendString(lineReset);
 
-void clearScreen(void)
-{
-    UART_sendString("\033[100A");                       // moves up lines
-//    UART_sendString("\033[0D");                       // moves left lines
-    UART_sendString("\033[2J");                       // uses clear screen character
+    restingState();
+    directSelect();
 
     return;
 }
 
 
-void restingState(void)
+void calibSave(int offset, unsigned int spread)
 {
-    while (1)
-    {
-        // Waits for thumbstick to be at rest
-        if ((Xper <= 60.0 && Xper >= 40.0) && (Yper <= 60.0 && Yper >= 40.0))
-        {
+    // Erase info segment B and write the new calibration into it
+    unsigned int* dst = (unsigned int*) CALIB_FLASH;
+
+    FCTL2 = FWKEY + FSSEL_1 + FN1;                          // MCLK / 3 ~= 350kHz flash timing generator
+    FCTL3 = FWKEY;                                          // unlock
+
+    FCTL1 = FWKEY + ERASE;                                  // segment erase
+    *dst = 0;                                               // dummy write starts the erase
+
+    FCTL1 = FWKEY + WRT;                                    // word writes
+    dst[1] = offset;
+    dst[2] = spread;
+    dst[0] = CALIB_MAGIC;                                   // magic last, so a half-written segment is never trusted
+
+    FCTL1 = FWKEY;
+    FCTL3 = FWKEY + LOCK;                                   // lock again
+
+    return;
+}
+
+
+void titleSequence(void)
+{
+    clearScreen();
+    UART_sendString("\033[H");                             // home, so the browser rows below line up
+
+    // Title
+    UART_sendString(lineReset);
+    UART_sendRaw(barWire);
+    UART_sendString(lineReset);
+    UART_sendString(lineReset);
+    UART_sendRaw(titleWire);
+    UART_sendString(lineReset);
+    UART_sendString(lineReset);
+    UART_sendRaw(barWire);
+    UART_sendString(lineReset);
+
+    // Song Choosing Instruction
+    UART_sendString(lineReset);
+    UART_sendRaw(chooseInstrWire);
+    UART_sendString(lineReset);
+
+    // Song Library Page (entries + page indicator)
+    drawPage();
+
+    // Ending Bar
+    UART_moveCursor(MENU_END_ROW - 1);
+    UART_sendRaw(barWire);
+    UART_sendString(lineReset);
+
+    restingState();
+
+
+    // Browsing - taps move the cursor or page, a hold picks the highlighted song
+    InputEvent e;
+    unsigned int pressTime = 0;
+    unsigned char pressMask = 0;
+    unsigned int pageCount = (SONG_COUNT + SONGS_PER_PAGE - 1) / SONGS_PER_PAGE;
+
+    while (1)
+    {
+        if (!pollEvent(&e))
+        {
+            // Nothing new: a stick still down for HOLD_TICKS picks right away, so the player sees the hold register
+            if (pressMask != 0 && (unsigned int)(sampleTick - pressTime) >= HOLD_TICKS)
+            {
+                break;
+            }
+            continue;
+        }
+
+        if (e.player != 0)                                  // only player 1 drives the menu
+        {
+            continue;
+        }
+
+        if (e.mask != 0)                                    // first panel down decides the action
+        {
+            if (pressMask == 0)
+            {
+                pressTime = e.time;
+                pressMask = e.mask;
+            }
+            continue;
+        }
+
+        if (pressMask == 0)                                 // release of something pressed before the menu
+        {
+            continue;
+        }
+
+        // Released: a release queued behind the hold deadline still counts as a hold
+        if ((unsigned int)(e.time - pressTime) >= HOLD_TICKS)
+        {
             break;
         }
+
+        unsigned char oldRow = browseRow;
+        unsigned int oldPage = browsePage;
+        unsigned int entriesOnPage = SONG_COUNT - browsePage * SONGS_PER_PAGE;
+
+        if (entriesOnPage > SONGS_PER_PAGE)
+        {
+            entriesOnPage = SONGS_PER_PAGE;
+        }
+
+        switch (pressMask)
+        {
+            // UP: previous entry
+            case STEP_U:
+                if (browseRow > 0)
+                {
+                    browseRow--;
+                }
+                break;
+
+            // DOWN: next entry
+            case STEP_D:
+                if ((unsigned int)browseRow + 1 < entriesOnPage)
+                {
+                    browseRow++;
+                }
+                break;
+
+            // LEFT: previous page
+            case STEP_L:
+                if (browsePage > 0)
+                {
+                    browsePage--;
+                    browseRow = 0;
+                    drawPage();
+                }
+                break;
+
+            // RIGHT: next page
+            case STEP_R:
+                if (browsePage + 1 < pageCount)
+                {
+                    browsePage++;
+                    browseRow = 0;
+                    drawPage();
+                }
+                break;
+
+            default:                                        // diagonals do nothing in the menu
+                break;
+        }
+        pressMask = 0;
+
+        if (browsePage == oldPage && browseRow != oldRow)   // cursor moved on the same page: only the two affected lines change
+        {
+            drawEntry(oldRow);
+            drawEntry(browseRow);
+        }
+
+        UART_moveCursor(MENU_END_ROW);                      // park the cursor below the menu
+    }
+
+
+    // Held: pick the highlighted song
+    const SongEntry* song = &songLibrary[browsePage * SONGS_PER_PAGE + browseRow];
+
+    songPtr = song->chart;
+    songLen = song->length;
+    selectConfirm(song->name);
+
+    return;
+}
+
+
+void drawEntry(unsigned char row)
+{
+    // Rewrites one browser line in place: "  > name ........ 15 steps  ***"
+    unsigned int index = browsePage * SONGS_PER_PAGE + row;
+
+    UART_moveCursor(MENU_ENTRY_ROW + row);
+    UART_sendString("\033[2K");                            // erase the old line
+
+    if (index >= SONG_COUNT)                                // past the end of the library (short last page)
+    {
+        return;
+    }
+
+    const SongEntry* song = &songLibrary[index];
+    const char* name = song->name;
+    int col = 0;
+    unsigned char i;
+
+    UART_sendString((row == browseRow) ? "      >  " : "         ");
+    while (*name != 0)
+    {
+        UART_putCharacter(*name++);
+        col++;
+    }
+    for (; col < 32; col++)                                 // line the lengths up in one column
+    {
+        UART_putCharacter(' ');
+    }
+
+    UART_sendNumber(song->length);
+    UART_sendString(" steps   ");
+
+    for (i = 0; i < song->difficulty; i++)
+    {
+        UART_putCharacter('*');
+    }
+
+    return;
+}
+
+
+void drawPage(void)
+{
+    // Redraws every entry line plus the page indicator - a fixed SONGS_PER_PAGE lines however big the library is
+    unsigned char row;
+
+    for (row = 0; row < SONGS_PER_PAGE; row++)
+    {
+        drawEntry(row);
+    }
+
+    UART_moveCursor(MENU_PAGE_ROW);
+    UART_sendString("\033[2K");
+    UART_sendString("                               Page ");
+    UART_sendNumber(browsePage + 1);
+    UART_sendString(" of ");
+    UART_sendNumber((SONG_COUNT + SONGS_PER_PAGE - 1) / SONGS_PER_PAGE);
+
+    return;
+}
+
+
+void stickSample(unsigned char player, unsigned int x, unsigned int y)
+{
+    // Called from ADC12ISR: queues the stick's new panel mask whenever it changes
+    Player* p = &players[player];
+    unsigned char mask = stickClassify(x, y, p->stickState);
+    InputEvent e;
+
+    if (mask == p->stickState)
+    {
+        return;
+    }
+
+    e.time = sampleTick;
+    e.player = player;
+    e.mask = mask;
+    eventPush(&inputQueue, &e);
+
+    p->stickState = mask;
+
+    return;
+}
+
+
+char pollEvent(InputEvent* e)
+{
+    if (!eventPop(&inputQueue, e))
+    {
+        return 0;
+    }
+
+    players[e->player].held = e->mask;                              // keep the game loop's view of each stick current
+
+    return 1;
+}
+
+
+void waitEvent(InputEvent* e)
+{
+    while (!pollEvent(e));                                          // sleep-free spin, same as the old polling loops
+
+    return;
+}
+
+
+unsigned char directSelect(void)
+{
+    InputEvent e;
+
+    while (1)                                                       // loop until player 1 presses a direction
+    {
+        waitEvent(&e);
+
+        if (e.player == 0 && e.mask != 0)
+        {
+            return e.mask;
+        }
+    }
+
+}
+
+
+void selectConfirm(const char* string)
+{
+    UART_sendString(lineReset);
+    UART_sendRaw(barWire);
+    UART_sendString(lineReset);
+    UART_sendString(lineReset);
+    UART_sendString(" Is \"");
+    UART_sendString(string);
+    UART_sendString("\" your selection?");
+    UART_sendString(lineReset);
+    UART_sendString(lineReset);
+    UART_sendString("    Yes   +   No    ");
+    UART_sendString(lineReset);
+    UART_sendString(lineReset);
+    UART_sendRaw(barWire);
+    UART_sendString(lineReset);
+
+
+    restingState();
+
+
+    while (1)                                           // infinite loop in case L or R direction is not used
+    {
+        unsigned char mask = directSelect();
+
+        switch (mask)
+        {
+            // LEFT: Yes
+            case STEP_L:
+                return;                                  // break out of song confirmation, song selection, and title sequence
+
+            // RIGHT: No
+            case STEP_R:
+                clearScreen();                          // clear screen
+                titleSequence();                        // replay title sequence again
+                return;
+
+            default:                                    // any other direction does nothing
+                break;
+        }
+    }
+
+}
+
+
+void clearScreen(void)
+{
+    UART_sendString("\033[100A");                       // moves up lines
+//    UART_sendString("\033[0D");                       // moves left lines
+    UART_sendString("\033[2J");                       // uses clear screen character
+
+    return;
+}
+
+
+void restingState(void)
+{
+    int i;
+    for (i = 0; i < numPlayers; i++)
+    {
+        InputEvent e;
+
+        while (players[i].held != 0)                    // Waits for every thumbstick to be at rest
+        {
+            waitEvent(&e);
+        }
     }
 
     return;
@@ -547,30 +1370,62 @@ void restingState(void)
 
 void endSongCondition(void)
 {
-    if (endSong == 'w')
+    if (numPlayers == 2)
+    {
+        // Versus Results
+        UART_sendString(lineReset);
+        UART_sendRaw(barWire);
+        UART_sendString(lineReset);
+        UART_sendString(lineReset);
+        UART_sendColumns(" Player 1", " Player 2");
+        UART_sendColumns((players[0].endSong == 'w') ? " Made it!!" : " Knocked out :(",
+                         (players[1].endSong == 'w') ? " Made it!!" : " Knocked out :(");
+        UART_sendString(lineReset);
+
+        switch (judgeWinner(players))                       // survival first, strikes only break a tie
+        {
+            case 0:
+                UART_sendString(" Player 1 Wins!! Congrats!!");
+                break;
+
+            case 1:
+                UART_sendString(" Player 2 Wins!! Congrats!!");
+                break;
+
+            default:
+                UART_sendString(" It's a Draw!!");
+                break;
+        }
+
+        UART_sendString(lineReset);
+        UART_sendString(lineReset);
+        UART_sendRaw(barWire);
+        UART_sendString(lineReset);
+    }
+    else if (players[0].endSong == 'w')
     {
         // Win Message
         UART_sendString(lineReset);
-        UART_sendString(bar);
+        UART_sendRaw(barWire);
         UART_sendString(lineReset);
         UART_sendString(lineReset);
         UART_sendString(" You Won!! Congrats!!");
         UART_sendString(lineReset);
         UART_sendString(lineReset);
-        UART_sendString(bar);
+        UART_sendRaw(barWire);
         UART_sendString(lineReset);
     }
-    else if (endSong == 'l')
+    else if (players[0].endSong == 'l')
     {
         // Lose Message
         UART_sendString(lineReset);
-        UART_sendString(bar);
+        UART_sendRaw(barWire);
         UART_sendString(lineReset);
         UART_sendString(lineReset);
         UART_sendString(" You lost :( Better Luck Next Time");
         UART_sendString(lineReset);
         UART_sendString(lineReset);
-        UART_sendString(bar);
+        UART_sendRaw(barWire);
         UART_sendString(lineReset);
     }
 
@@ -581,7 +1436,7 @@ void endSongCondition(void)
 char playAgain(void)
 {
     UART_sendString(lineReset);
-    UART_sendString(bar);
+    UART_sendRaw(barWire);
     UART_sendString(lineReset);
     UART_sendString(lineReset);
     UART_sendString(" Play Again? ");
@@ -590,7 +1445,7 @@ char playAgain(void)
     UART_sendString("    Yes   +   No    ");
     UART_sendString(lineReset);
     UART_sendString(lineReset);
-    UART_sendString(bar);
+    UART_sendRaw(barWire);
     UART_sendString(lineReset);
 
 
@@ -599,17 +1454,17 @@ char playAgain(void)
 
     while (1)
     {
-        char dir = directSelect();
+        unsigned char mask = directSelect();
 
-        switch (dir)
+        switch (mask)
         {
             // LEFT: Yes
-            case 'L':
+            case STEP_L:
                 resetLEDs();                                                // make sure LEDs turn off before every game
                 return 'y';
 
             // RIGHT: No
-            case 'R':
+            case STEP_R:
                 resetLEDs();                                                // make sure LEDs turn off before every game
                 return 'n';
 
@@ -621,95 +1476,325 @@ char playAgain(void)
 }
 
 
-void arrowOutput(int iter)
+void arrowPrepare(unsigned int iter)
 {
-    clearScreen();
+    // Gets beat "iter" ready ahead of the WDT, nothing is sent here
+    if (frameReady)                                         // already built and waiting on the beat
+    {
+        return;
+    }
+
+#if PIPELINED_OUTPUT
+    frameBuild(frameBack, iter);
+#else
+    frameIter = iter;                                       // old path: built inside the beat interrupt instead
+#endif
+
+    frameReady = 1;                                         // publish last, the WDT may fire any time
+
+    return;
+}
+
 
-    switch (songPtr[iter])
+void frameBuild(Frame* f, unsigned int iter)
+{
+    // Builds the whole output for beat "iter" into "f"
+    f->length = 0;
+    frameAppend(f, "\033[100A");                            // same as clearScreen()
+    frameAppend(f, "\033[2J");
+    frameAppend(f, lineReset);
+
+    // One glyph per panel in the step mask, jumps are laid out two side by side per row
+    unsigned char mask = songPtr[iter];
+    unsigned char panel[4];
+    unsigned char count = 0;
+    unsigned int toneSum = 0;
+    unsigned char i;
+
+    for (i = 0; i < 4; i++)
     {
-        // UP
-        case 'U':
-            UART_sendString(lineReset);
-            UART_sendString(up);
-            UART_sendString(lineReset);
+        if (mask & (1 << i))
+        {
+            panel[count++] = i;
+            toneSum += panelTone[i];
+        }
+    }
 
-            TB0CCR0 = 16;                                  // high freq
+    for (i = 0; i + 1 < count; i += 2)
+    {
+        frameAppendColumns(f, panelGlyph[panel[i]], panelGlyph[panel[i + 1]]);
+    }
+    if (i < count)                                          // odd one out gets a row to itself, already encoded
+    {
+        frameAppendRaw(f, panelWire[panel[i]]);
+    }
 
-            return;
+    f->tone = (count != 0) ? toneSum / count : panelTone[2];  // jumps sound between their panels' tones
 
-        // DOWN
-        case 'D':
-            UART_sendString(lineReset);
-            UART_sendString(down);
-            UART_sendString(lineReset);
+    frameAppend(f, lineReset);
 
-            TB0CCR0 = 99;                                  // muy low freq
+    return;
+}
 
-            return;
 
-        // LEFT
-        case 'L':
-            UART_sendString(lineReset);
-            UART_sendString(left);
-            UART_sendString(lineReset);
+void frameKick(void)
+{
+    beatStamp = timerA_now();
+    beatTick = sampleTick;
+
+#if PIPELINED_OUTPUT
+    // Swap buffers - the frame and its tone were already built during the previous beat
+    Frame* f = frameBack;
+    frameBack = frameFront;
+    frameFront = f;
+    frameReady = 0;
+
+    TB0CCR0 = frameFront->tone;
+    SET_BUZZER();                                           // turn on buzzer
+
+    // Start transmission - TX interrupt fires as soon as the buffer is free and sends every byte
+    frameSending = 1;
+    txIndex = 0;
+    IE2 |= UCA0TXIE;
+#else
+    // Old path, kept to measure against: build and send the whole beat right here, in the interrupt
+    unsigned int i;
+
+    frameBuild(frameFront, frameIter);
+    frameReady = 0;
+
+    TB0CCR0 = frameFront->tone;
+    SET_BUZZER();
+
+    for (i = 0; i < frameFront->length; i++)
+    {
+        while (!(IFG2 & UCA0TXIFG));
+        UCA0TXBUF = frameFront->bytes[i];
+        if (i == 0)
+        {
+            latencyRecord(0);                               // same stamp points as USCIA0TX_ISR
+        }
+    }
+    while (!(IFG2 & UCA0TXIFG));                            // last byte moved into the shift register
+    latencyRecord(1);
+#endif
 
-            TB0CCR0 = 37;                                  // idk freq 1
+    return;
+}
 
-            return;
 
-        // RIGHT
-        case 'R':
-            UART_sendString(lineReset);
-            UART_sendString(right);
-            UART_sendString(lineReset);
+void frameAppend(Frame* f, const char* string)
+{
+    // Same wire encoding as UART_sendString(), done ahead of the beat
+    unsigned int used;
+    unsigned char len;
+
+    while (*string != 0 && f->length + WIRE_TOKEN_MAX <= FRAME_SIZE)
+    {
+        len = wireToken(string, &used, &f->bytes[f->length]);
+        f->length += len;
+        string += used;
+    }
+
+    return;
+}
 
-            TB0CCR0 = 75;                                  // idk freq 2: electric boogaloo
 
-            return;
+void frameAppendRaw(Frame* f, const char* wire)
+{
+    // symbolsWire.h strings go in byte for byte
+    while (*wire != 0 && f->length < FRAME_SIZE)
+    {
+        f->bytes[f->length++] = *wire++;
     }
 
+    return;
+}
+
+
+void frameAppendColumns(Frame* f, const char* leftStr, const char* rightStr)
+{
+    // Same as UART_sendColumns(), into the frame
+    char line[LINE_SIZE + 1];
+
+    while (*leftStr != 0 || *rightStr != 0)
+    {
+        columnLine(&leftStr, &rightStr, line);
+        frameAppend(f, line);
+        frameAppend(f, lineReset);
+    }
+
+    return;
+}
+
+
+void latencyRecord(char last)
+{
+    // Beat -> first byte (last = 0) or beat -> last byte in the shift register (last = 1), keeps the worst of each
+    unsigned int t = (unsigned int)timerA_since(beatStamp);       // a frame never takes anywhere near 2s
+
+    if (!last)
+    {
+        latencyFirst = t;
+        if (t > latencyFirstMax)
+        {
+            latencyFirstMax = t;
+        }
+    }
+    else
+    {
+        latencyLast = t;
+        if (t > latencyLastMax)
+        {
+            latencyLastMax = t;
+        }
+    }
+
+    return;
+}
+
+
+unsigned int timerA_read(void)
+{
+    // TAR counts on ACLK, asynchronous to MCLK, so a single read can catch it mid-update: majority vote
+    unsigned int a, b = TAR;
+
+    do
+    {
+        a = b;
+        b = TAR;
+    } while (a != b);
+
+    return b;
+}
+
+
+unsigned long timerA_now(void)
+{
+    // 32-bit Timer A clock (30.5us ticks, wraps after ~36 hours): overflow count on top, TAR below
+    unsigned int hi, lo;
+
+    do
+    {
+        hi = timerAOverflow;
+        lo = timerA_read();
+    } while (hi != timerAOverflow);
+
+    if ((TACTL & TAIFG) && lo < 0x8000)             // wrapped, but the overflow interrupt hasn't run yet (called from an ISR)
+    {
+        hi++;
+    }
+
+    return ((unsigned long)hi << 16) | lo;
+}
+
+
+unsigned long timerA_since(unsigned long stamp)
+{
+    // Timer A ticks elapsed since "stamp" (a timerA_now() value), any number of wraps
+    return timerA_now() - stamp;
+}
+
+
+void beatFire(void)
+{
+    // One beat (WDT in a song, CCR1 in the benchmark): start the prebuilt frame if the pipeline can take it
+    if (frameSending)                               // last frame still going out
+    {
+        beatOverrun(STAGE_OUTPUT);
+        return;
+    }
+    if (!frameReady)                                // main loop hasn't built this beat yet
+    {
+        beatOverrun(loopStage);
+        return;
+    }
+
+    frameKick();                                    // swap in the prebuilt frame and start sending it
+    arrowSent = 1;                                  // arrow sent flag to True
+
+    return;
+}
+
+
+void beatOverrun(char stage)
+{
+    beatOverruns++;
+    if (overrunStage < 0)
+    {
+        overrunStage = stage;
+    }
+
+    return;
 }
 
 
 void directConfirm(void)
 {
-    char dir = directSelect();
+    // Judge every active player against the same step, whoever commits a direction first gets judged first
+    unsigned char step = songPtr[songIter];
+    char pending = judgeBegin(players, numPlayers);          // bitmask of players still waiting on a direction
 
-    // debugging shit
-//    UART_putCharacter(dir);
-//    UART_sendString(lineReset);
-//    UART_putCharacter(songPtr[songIter]);
+    while (pending)                                          // both sticks share one queue, no extra sampling needed
+    {
+        InputEvent e;
 
+        if (pollEvent(&e))
+        {
+            judgeEvent(players, &pending, &e, step, beatTick, judgeOffset);
+        }
+        else if (judgeExpired(sampleTick, beatTick, judgeOffset))
+        {
+            judgeClose(players, &pending, step);             // queue drained and the window is over: nobody waits on an idle stick
+        }
+    }
 
-    if (dir == songPtr[songIter])                            // if correct direction chosen
+
+    // Results
+    UART_sendString(lineReset);
+    if (numPlayers == 2)
     {
-        UART_sendString(lineReset);
-        UART_sendString(correct);
-        UART_sendString(lineReset);
+        UART_sendColumns((players[0].result == 'h') ? correct : (players[0].result == 'm') ? miss : "",
+                         (players[1].result == 'h') ? correct : (players[1].result == 'm') ? miss : "");
     }
-    else if (dir != songPtr[songIter])                       // if incorrect/no direction chosen
+    else
     {
-        UART_sendString(lineReset);
-        UART_sendString(miss);
-        UART_sendString(lineReset);
+        UART_sendRaw((players[0].result == 'h') ? correctWire : missWire);
+    }
+    UART_sendString(lineReset);
 
-        strike++;                                            // increase strike counter
 
-        if (strike == 1)
+    // Strike LEDs follow player 1
+    if (players[0].result == 'm')
+    {
+        if (players[0].strike == 1)
         {
             SET_GREEN();
         }
-        else if (strike == 2)
+        else if (players[0].strike == 2)
         {
             SET_YELLOW();
         }
-        else if (strike >= 3)
+        else if (players[0].strike >= 3)
         {
             SET_RED();
-            endSong = 'l';                                   // send bad ending flag
         }
     }
 
     return;
 }
 
+
+char songInProgress(void)
+{
+    int i;
+    for (i = 0; i < numPlayers; i++)
+    {
+        if (players[i].endSong == 'p')                       // song keeps going while anyone is still in
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -1,22 +1,66 @@
-
 /* Arrays of songs for final project - max length: 35 */
+/* Everything here is const so the linker keeps it in flash, not RAM */
+
+#include "gameLogic.h"                                      // STEP_* panel bits a chart is written in
+
+
+const char song1Name[] = "4618-misia";
+const unsigned char song1[] = { STEP_L, STEP_L, STEP_D, STEP_D, STEP_R, STEP_U, STEP_R, STEP_U,
+                                STEP_D, STEP_D, STEP_L, STEP_R, STEP_D, STEP_U, STEP_R };
+
+
+const char song2Name[] = "big fricken dude";
+const unsigned char song2[] = { STEP_D, STEP_U, STEP_D, STEP_U, STEP_R, STEP_R, STEP_R, STEP_D,
+                                STEP_D, STEP_U, STEP_D, STEP_U, STEP_R, STEP_R, STEP_R };
+
+
+const char song3Name[] = "Analog Nonsense";
+const unsigned char song3[] = { STEP_U, STEP_U, STEP_D, STEP_D, STEP_L, STEP_R, STEP_L, STEP_R,
+                                STEP_U, STEP_D, STEP_R, STEP_R, STEP_L, STEP_L, STEP_D };
+
+
+const char song4Name[] = "Tribute to Jackson Lawrence";
+const unsigned char song4[] = { STEP_D, STEP_D, STEP_D, STEP_D, STEP_D, STEP_D, STEP_D, STEP_D,
+                                STEP_D, STEP_D, STEP_D, STEP_D, STEP_D, STEP_D, STEP_D };
+
+
+const char song5Name[] = "Diagonal Drift";
+const unsigned char song5[] = { STEP_U, STEP_U | STEP_L, STEP_L, STEP_D | STEP_L, STEP_D, STEP_D | STEP_R,
+                                STEP_R, STEP_U | STEP_R, STEP_U, STEP_D, STEP_U | STEP_L, STEP_D | STEP_R,
+                                STEP_U | STEP_R, STEP_D | STEP_L, STEP_U };
+
+
+
+/* Song Library Index - one fixed-size entry per song, looked up by position */
+
+typedef struct
+{
+    const char* name;                                       // display name
+    const unsigned char* chart;                             // step masks
+    unsigned int length;                                    // number of steps in the chart
+    unsigned char difficulty;                               // 1 (easy) to 5 (hard), shown as stars
+} SongEntry;
+
+#define SONG_ENTRY(name, chart, difficulty) { name, chart, sizeof(chart), difficulty }
+
+const SongEntry songLibrary[] =
+{
+    SONG_ENTRY(song1Name, song1, 3),
+    SONG_ENTRY(song2Name, song2, 2),
+    SONG_ENTRY(song3Name, song3, 3),
+    SONG_ENTRY(song4Name, song4, 1),
+    SONG_ENTRY(song5Name, song5, 4),
+};
 
-char song1Name[] = "4618-misia";
-char song1[] = "LLDDRURUDDLRDUR";
-int song1Len = (*(&song1 + 1) - song1) - 1;
+#define SONG_COUNT (sizeof(songLibrary) / sizeof(songLibrary[0]))
 
 
-char song2Name[] = "big fricken dude";
-char song2[] = "DUDURRRDDUDURRR";
-int song2Len = (*(&song2 + 1) - song2) - 1;
 
+/* Synthetic chart for benchmark mode - every arrow plus two jumps, looped */
 
-char song3Name[] = "Analog Nonsense";
-char song3[] = "UUDDLRLRUDRRLLD";
-int song3Len = (*(&song3 + 1) - song3) - 1;
+const unsigned char benchChart[] = { STEP_U, STEP_D, STEP_L, STEP_R, STEP_U | STEP_L, STEP_D | STEP_R };
 
 
-char song4Name[] = "Tribute to Jackson Lawrence";
-char song4[] = "DDDDDDDDDDDDDDD";
-int song4Len = (*(&song4 + 1) - song4) - 1 ;
+/* Metronome chart for calibration mode - the same arrow every beat */
 
+const unsigned char calibChart[] = { STEP_U };
@@ -7,10 +7,10 @@ char lineReset[] = "\r\n";
 // Menu
 char title[]       = "#=---------+ Boggie Boogie Reformation 2: Electric Boogaloo +---------=#";
 char bar[]         = "#=-------------------------------=+#+=--------------------------------=#";
-char chooseInstr[] = "#=---------+       Use the joystick to choose a song        +---------=#";
-char songChoice1[] = "                                Song #1                                 ";
-char songChoice2[] = "                      Song #2      +      Song #3                       ";
-char songChoice3[] = "                                Song #4                                 ";
+char chooseInstr[] = "#=---------+  Tap U/D: move   L/R: page   Hold: pick song   +---------=#";
+char calibChoice[] = "                               Calibrate                                ";
+char modeChoice[]  = "                      1 Player     +     2 Players                      ";
+char benchChoice[] = "                               Benchmark                                ";
 
 
 // Hits/Misses
@@ -0,0 +1,94 @@
+/* Pre-encoded wire forms of the static strings in symbols.h (encoding: see wire.c) */
+/* Sent byte for byte with UART_sendRaw()/frameAppendRaw(), nothing is encoded at run time */
+/* Generated - do not edit: "make -C tests wire-table" rewrites this file from symbols.h, */
+/* and tests/test_wire fails as soon as the two drift apart */
+
+
+// Menu
+const char barWire[]         = "#=-\033[30b=+#+=-\033[31b=#";
+const char titleWire[]       = "#=-\033[8b+ Boggie Boogie Reformation 2: Electric Boogaloo +-\033[8b=#";
+const char chooseInstrWire[] = "#=-\033[8b+  Tap U/D: move   L/R: page   Hold: pick song   +-\033[8b=#";
+const char calibChoiceWire[] = "\033[31CCalibrate\033[32C";
+const char modeChoiceWire[]  = "\033[22C1 Player\033[5C+\033[5C2 Players\033[22C";
+const char benchChoiceWire[] = "\033[31CBenchmark\033[32C";
+const char menuWire[]        = "\033[100A\033[2J\r\n"
+                               "#=-\033[30b=+#+=-\033[31b=#\r\n"
+                               "\r\n"
+                               "#=-\033[8b+ Boggie Boogie Reformation 2: Electric Boogaloo +-\033[8b=#\r\n"
+                               "\r\n"
+                               "#=-\033[30b=+#+=-\033[31b=#\r\n"
+                               "\r\n"
+                               "\033[31CCalibrate\r\n"
+                               "\033[22C1 Player\033[5C+\033[5C2 Players\r\n"
+                               "\033[31CBenchmark\r\n"
+                               "\r\n"
+                               "#=-\033[30b=+#+=-\033[31b=#\r\n";
+
+
+// Hits/Misses
+const char missWire[]        = " \\\\ \\\\\033[9C// //\n\r"
+                               "  \\\\ \\\\\033[7C// //\n\r"
+                               "   \\\\ \\\\\033[5C// //\n\r"
+                               "    \\\\ \\\\   // //\n\r"
+                               "\033[5C\\\\ \\\\ // //\n\r"
+                               "\033[5C// // \\\\ \\\\\n\r"
+                               "    // //   \\\\ \\\\\n\r"
+                               "   // //\033[5C\\\\ \\\\\n\r"
+                               "  // //\033[7C\\\\ \\\\\n\r"
+                               " // //\033[9C\\\\ \\\\\n\r";
+const char correctWire[]     = "!\033[14C// //\n\r"
+                               "\033[14C// //\n\r"
+                               "\033[13C// //\n\r"
+                               "\033[12C// //\n\r"
+                               "\033[11C// //\n\r"
+                               "\033[10C// //\n\r"
+                               "\033[9C// //\n\r"
+                               "\\\\ \\\\   // //\n\r"
+                               " \\\\ \\\\ // //\n\r"
+                               "  \\\\ \\\\  //\n\r"
+                               "   \\\\\\\\\\//\n\r";
+
+
+// Arrows
+const char upWire[]          = "    /\\\n\r"
+                               "   /  \\\n\r"
+                               "  /    \\\n\r"
+                               " /\033[6C\\\n\r"
+                               "/\033[8C\\\n\r"
+                               "----  ----\n\r"
+                               "   |  |\n\r"
+                               "   |  |\n\r"
+                               "   |  |\n\r"
+                               "   |  |\n\r"
+                               "   |__|\n\r";
+const char downWire[]        = "   |--|\n\r"
+                               "   |  |\n\r"
+                               "   |  |\n\r"
+                               "   |  |\n\r"
+                               "   |  |\n\r"
+                               "----  ----\n\r"
+                               "\\\033[8C/\n\r"
+                               " \\\033[6C/\n\r"
+                               "  \\    /\n\r"
+                               "   \\  /\n\r"
+                               "    \\/\n\r";
+const char leftWire[]        = "    /|\n\r"
+                               "   / |\n\r"
+                               "  /  |\n\r"
+                               " /    -\033[14b\n\r"
+                               "/\033[20C|\n\r"
+                               "\\\033[20C|\n\r"
+                               " \\    -\033[14b\n\r"
+                               "  \\  |\n\r"
+                               "   \\ |\n\r"
+                               "    \\|\n\r";
+const char rightWire[]       = "\033[16C|\\\n\r"
+                               "\033[16C| \\\n\r"
+                               "\033[16C|  \\\n\r"
+                               " -\033[14b    \\\n\r"
+                               "|\033[20C\\\n\r"
+                               "|\033[20C/\n\r"
+                               " -\033[14b    /\n\r"
+                               "\033[16C|  /\n\r"
+                               "\033[16C| /\n\r"
+                               "\033[16C|/\n\r";
@@ -0,0 +1,24 @@
+/* Host Test Checks - shared by every test in this directory, each test is a single translation unit */
+/* CHECK reports the failing line and returns from the current case, main returns 1 if failures != 0 */
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                    \
+    do                                                      \
+    {                                                       \
+        if (!(cond))                                        \
+        {                                                   \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);     \
+            printf(__VA_ARGS__);                            \
+            printf("\n");                                   \
+            failures++;                                     \
+            return;                                         \
+        }                                                   \
+    } while (0)
+
+#endif
@@ -0,0 +1,120 @@
+/*------------------------------------------------------------------------------
+ * File:        test_calibStats.c
+ * Description: Host test for the calibration median / interquartile range.
+ *              Hand-checked sets (odd and even counts, a single sample, skewed
+ *              sets with outliers) plus random sets compared against qsort and
+ *              the same nearest-rank quartiles.
+ *----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gameLogic.h"
+#include "check.h"
+
+#define SET_MAX 32
+
+
+typedef struct
+{
+    const char* name;
+    unsigned char n;
+    unsigned int samples[SET_MAX];
+    unsigned int median;
+    unsigned int spread;
+} StatsCase;
+
+static const StatsCase cases[] = {
+    { "single sample",       1, { 7 },                                        7, 0 },
+    { "two samples",         2, { 9, 4 },                                     6, 5 },   // (4 + 9) / 2 rounds down
+    { "odd, unsorted",       5, { 5, 1, 4, 2, 3 },                            3, 2 },
+    { "even, unsorted",      6, { 6, 1, 5, 2, 4, 3 },                         3, 3 },
+    { "all equal",           4, { 4, 4, 4, 4 },                               4, 0 },
+    { "reverse sorted",      7, { 7, 6, 5, 4, 3, 2, 1 },                      4, 4 },
+    { "late outlier",       12, { 3, 4, 4, 3, 5, 4, 3, 4, 40, 4, 5, 3 },      4, 2 },
+    { "jumped the gun",     12, { 0, 0, 0, 4, 5, 4, 0, 4, 5, 4, 4, 5 },       4, 5 },
+    { "one slow half",       8, { 2, 2, 2, 2, 9, 9, 9, 9 },                   5, 7 },
+    { "mostly zero",         9, { 0, 0, 0, 0, 0, 0, 0, 0, 30 },               0, 0 },
+};
+
+
+static void testCases(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        unsigned int samples[SET_MAX];
+        unsigned int median, spread;
+        unsigned char k;
+
+        memcpy(samples, cases[i].samples, sizeof(samples));
+        calibStats(samples, cases[i].n, &median, &spread);
+
+        CHECK(median == cases[i].median, "%s: median %u, expected %u", cases[i].name, median, cases[i].median);
+        CHECK(spread == cases[i].spread, "%s: spread %u, expected %u", cases[i].name, spread, cases[i].spread);
+        for (k = 1; k < cases[i].n; k++)
+        {
+            CHECK(samples[k - 1] <= samples[k], "%s: not sorted at %u", cases[i].name, k);
+        }
+    }
+
+    printf("ok   %u hand-checked sets (odd, even, n=1, skewed)\n", (unsigned int)(sizeof(cases) / sizeof(cases[0])));
+}
+
+
+static int compareUnsigned(const void* a, const void* b)
+{
+    unsigned int x = *(const unsigned int*)a;
+    unsigned int y = *(const unsigned int*)b;
+
+    return (x > y) - (x < y);
+}
+
+
+static void testRandomSets(void)
+{
+    int round;
+
+    srand(4618);
+    for (round = 0; round < 100000; round++)
+    {
+        unsigned int samples[SET_MAX], sorted[SET_MAX];
+        unsigned int median, spread, wantMedian;
+        unsigned char n = 1 + rand() % SET_MAX;
+        unsigned char k;
+
+        for (k = 0; k < n; k++)
+        {
+            samples[k] = (rand() % 4) ? rand() % 10 : rand() % 65536;          // mostly small, some huge outliers
+            sorted[k] = samples[k];
+        }
+        qsort(sorted, n, sizeof(sorted[0]), compareUnsigned);
+
+        calibStats(samples, n, &median, &spread);
+
+        wantMedian = (n & 1) ? sorted[n / 2] : (unsigned int)(((unsigned long)sorted[n / 2 - 1] + sorted[n / 2]) / 2);
+        CHECK(memcmp(samples, sorted, n * sizeof(sorted[0])) == 0, "round %d: sort differs from qsort (n=%u)", round, n);
+        CHECK(median == wantMedian, "round %d: median %u, expected %u (n=%u)", round, median, wantMedian, n);
+        CHECK(spread == sorted[(3 * n) / 4] - sorted[n / 4], "round %d: spread %u (n=%u)", round, spread, n);
+        CHECK(median >= sorted[0] && median <= sorted[n - 1], "round %d: median %u outside the samples", round, median);
+    }
+
+    printf("ok   100000 random sets match qsort\n");
+}
+
+
+int main(void)
+{
+    testCases();
+    testRandomSets();
+
+    if (failures != 0)
+    {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
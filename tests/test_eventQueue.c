@@ -0,0 +1,248 @@
+/*------------------------------------------------------------------------------
+ * File:        test_eventQueue.c
+ * Description: Host stress test for the SPSC input event ring.
+ *              1) Single-threaded: producer and consumer steps interleaved at
+ *                 random, checked against a reference model (FIFO order, no loss
+ *                 below capacity, exact overflow and highWater counts).
+ *              2) Two threads hammering push/pop at the same time, checking
+ *                 FIFO order and that every event is either received or counted
+ *                 as overflow.
+ *----------------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L                             // rand_r
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "eventQueue.h"
+#include "check.h"
+
+#define CAPACITY (EVENT_QUEUE_SIZE - 1)                     // one slot is always kept empty
+
+
+static InputEvent makeEvent(unsigned int seq)
+{
+    InputEvent e;
+
+    e.time = seq;                                           // sequence number doubles as the payload
+    e.player = seq & 1;
+    e.mask = (seq % 15) + 1;
+
+    return e;
+}
+
+
+static void testRandomInterleave(unsigned int seed)
+{
+    EventQueue q;
+    InputEvent e;
+    unsigned int sent = 0, received = 0, dropped = 0;
+    unsigned int waiting = 0, highWater = 0;
+    int step;
+
+    srand(seed);
+    eventReset(&q);
+
+    for (step = 0; step < 200000; step++)
+    {
+        // Bias towards pushing or popping in long stretches so the ring both fills and drains
+        int pushBias = ((step / 997) & 1) ? 60 : 40;
+
+        if (rand() % 100 < pushBias)
+        {
+            InputEvent in = makeEvent(sent + dropped);
+            char ok = eventPush(&q, &in);
+
+            if (waiting < CAPACITY)
+            {
+                CHECK(ok, "push refused with %u/%d waiting", waiting, CAPACITY);
+                sent++;
+                waiting++;
+                if (waiting > highWater)
+                {
+                    highWater = waiting;
+                }
+            }
+            else
+            {
+                CHECK(!ok, "push accepted into a full ring");
+                dropped++;
+                // a dropped sequence number is skipped by the consumer below
+            }
+        }
+        else
+        {
+            char ok = eventPop(&q, &e);
+
+            if (waiting == 0)
+            {
+                CHECK(!ok, "pop returned an event from an empty ring");
+            }
+            else
+            {
+                CHECK(ok, "pop failed with %u waiting", waiting);
+                CHECK(e.time >= received, "event %u came out of order", e.time);
+                CHECK(e.player == (e.time & 1) && e.mask == (e.time % 15) + 1, "event %u payload corrupted", e.time);
+                received = e.time + 1;
+                waiting--;
+            }
+        }
+
+        CHECK(q.overflow == dropped, "overflow %u, expected %u", q.overflow, dropped);
+        CHECK(q.highWater == highWater, "highWater %u, expected %u", q.highWater, highWater);
+    }
+
+    while (eventPop(&q, &e))                                // drain: nothing below capacity may be lost
+    {
+        waiting--;
+    }
+    CHECK(waiting == 0, "%u events lost", waiting);
+
+    printf("ok   random interleave (seed %u): %u sent, %u dropped, highWater %u\n", seed, sent, dropped, highWater);
+}
+
+
+static void testNoLossBelowCapacity(void)
+{
+    EventQueue q;
+    InputEvent e;
+    unsigned int i, round;
+
+    eventReset(&q);
+
+    for (round = 0; round < 100; round++)                   // wrap the indexes many times
+    {
+        unsigned int n = (round % CAPACITY) + 1;
+
+        for (i = 0; i < n; i++)
+        {
+            InputEvent in = makeEvent(i);
+            CHECK(eventPush(&q, &in), "push %u of %u refused", i, n);
+        }
+        for (i = 0; i < n; i++)
+        {
+            CHECK(eventPop(&q, &e) && e.time == i, "event %u of %u missing or out of order", i, n);
+        }
+        CHECK(!eventPop(&q, &e), "ring not empty after draining");
+    }
+
+    CHECK(q.overflow == 0, "overflow counted below capacity");
+    CHECK(q.highWater == CAPACITY, "highWater %u, expected %d", q.highWater, CAPACITY);
+
+    printf("ok   no loss below capacity\n");
+}
+
+
+// Two-thread stress -----------------------------------------------------------
+#define THREAD_EVENTS 200000u
+
+static EventQueue shared;
+static volatile unsigned int producerDone = 0;
+static unsigned int failedPushes = 0;                      // written by the producer thread only
+static unsigned int givenUp = 0;                           // events the producer stopped retrying
+
+static void spin(unsigned int n)
+{
+    volatile unsigned int i;
+
+    for (i = 0; i < n; i++);
+
+    return;
+}
+
+static void* producer(void* arg)
+{
+    unsigned int seq;
+    unsigned int seed = 1234;
+    (void) arg;
+
+    for (seq = 0; seq < THREAD_EVENTS; seq++)
+    {
+        InputEvent in = makeEvent(seq);
+        unsigned int retries = rand_r(&seed) % 64;          // sometimes wait for room, sometimes drop straight away
+
+        while (!eventPush(&shared, &in))
+        {
+            failedPushes++;                                 // every refused push must show up in overflow
+            if (retries-- == 0)
+            {
+                givenUp++;
+                break;
+            }
+            sched_yield();
+        }
+        spin(rand_r(&seed) % 16);                           // random gaps so pushes land at random points of a pop
+    }
+    producerDone = 1;
+
+    return 0;
+}
+
+static void testThreads(void)
+{
+    pthread_t thread;
+    InputEvent e;
+    unsigned int received = 0;
+    unsigned int last = 0;
+    int first = 1;
+
+    unsigned int seed = 99;
+
+    eventReset(&shared);
+    pthread_create(&thread, 0, producer, 0);
+
+    while (1)
+    {
+        if (eventPop(&shared, &e))
+        {
+            CHECK(first || e.time > last, "event %u after %u", e.time, last);
+            CHECK(e.player == (e.time & 1) && e.mask == (e.time % 15) + 1, "event %u payload torn", e.time);
+            last = e.time;
+            first = 0;
+            received++;
+            spin(rand_r(&seed) % 24);
+        }
+        else if (!producerDone)
+        {
+            sched_yield();                                  // give a single-core host a chance to run the producer
+        }
+        else
+        {
+            if (!eventPop(&shared, &e))                     // one last look now the producer has stopped
+            {
+                break;
+            }
+            CHECK(e.time > last, "event %u after %u", e.time, last);
+            last = e.time;
+            received++;
+        }
+    }
+
+    pthread_join(thread, 0);
+
+    CHECK(received + givenUp == THREAD_EVENTS, "%u received + %u given up != %u sent", received, givenUp, THREAD_EVENTS);
+    CHECK(shared.overflow == failedPushes, "overflow %u, expected %u", shared.overflow, failedPushes);
+
+    printf("ok   two threads: %u received, %u given up, %u refused pushes, highWater %u\n",
+           received, givenUp, failedPushes, shared.highWater);
+}
+
+
+int main(void)
+{
+    testNoLossBelowCapacity();
+    testRandomInterleave(1);
+    testRandomInterleave(325);
+    testRandomInterleave(4618);
+    testThreads();
+
+    if (failures != 0)
+    {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
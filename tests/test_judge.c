@@ -0,0 +1,441 @@
+/*------------------------------------------------------------------------------
+ * File:        test_judge.c
+ * Description: Host test for the versus-mode beat judgment.
+ *              Two players' input traces are interleaved into one event stream
+ *              (the way ADC12ISR queues them) and every player must come out
+ *              with the result they would have got playing alone: pending mask,
+ *              per-player routing, chord building and the timing window.
+ *              Also checks the chord -> hit/miss mask compare on its own, who
+ *              wins a versus song (survival before strikes), and that a beat
+ *              closes on the clock when a player never moves, early enough
+ *              that the next beat's frame is always ready in time.
+ *----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gameLogic.h"
+#include "check.h"
+
+#define BEAT 100                                            // beatTick used by every case
+#define OFFSET 4                                            // judgeOffset used by every case
+#define TRACE_MAX 8
+
+
+typedef struct
+{
+    unsigned int length;
+    InputEvent events[TRACE_MAX];
+} Trace;
+
+
+static void freshPlayers(Player* players)
+{
+    memset(players, 0, 2 * sizeof(Player));
+    players[0].endSong = 'p';
+    players[1].endSong = 'p';
+}
+
+
+// Feed events until nobody is pending (or the stream runs out), like directConfirm does
+static char judgeStream(Player* players, unsigned char numPlayers, const InputEvent* events, unsigned int count,
+                        unsigned char step)
+{
+    char pending = judgeBegin(players, numPlayers);
+    unsigned int i;
+
+    for (i = 0; i < count && pending; i++)
+    {
+        judgeEvent(players, &pending, &events[i], step, BEAT, OFFSET);
+    }
+
+    return pending;
+}
+
+
+// Merge two traces in time order, ties alternate so neither player always goes first
+static unsigned int interleave(const Trace* a, const Trace* b, InputEvent* out, unsigned int seed)
+{
+    unsigned int i = 0, j = 0, n = 0;
+
+    while (i < a->length || j < b->length)
+    {
+        char takeA;
+
+        if (i >= a->length)
+        {
+            takeA = 0;
+        }
+        else if (j >= b->length)
+        {
+            takeA = 1;
+        }
+        else if (a->events[i].time != b->events[j].time)
+        {
+            takeA = a->events[i].time < b->events[j].time;
+        }
+        else
+        {
+            takeA = (seed >> (n & 15)) & 1;
+        }
+
+        out[n++] = takeA ? a->events[i++] : b->events[j++];
+    }
+
+    return n;
+}
+
+
+static void addEvent(Trace* t, unsigned int time, unsigned char player, unsigned char mask)
+{
+    t->events[t->length].time = time;
+    t->events[t->length].player = player;
+    t->events[t->length].mask = mask;
+    t->length++;
+}
+
+
+static void testInterleavedTraces(void)
+{
+    Player players[2];
+    Trace a = {0}, b = {0};
+    InputEvent merged[2 * TRACE_MAX];
+    unsigned int n;
+
+    // Jump U+L: player 1 hits both together on time, player 2 rolls L then U on time
+    addEvent(&a, BEAT + 4, 0, STEP_U | STEP_L);
+    addEvent(&b, BEAT + 3, 1, STEP_L);
+    addEvent(&b, BEAT + 5, 1, STEP_U | STEP_L);
+
+    n = interleave(&a, &b, merged, 0);
+    freshPlayers(players);
+    CHECK(judgeStream(players, 2, merged, n, STEP_U | STEP_L) == 0, "someone still pending");
+    CHECK(players[0].result == 'h', "player 1 got '%c', expected a hit", players[0].result);
+    CHECK(players[1].result == 'h', "player 2 got '%c', expected a hit", players[1].result);
+    CHECK(players[1].pressTime == BEAT + 3, "player 2 clock started at %u", players[1].pressTime);
+
+    // Step U: player 1 hits R (wrong panel), player 2 hits U on time
+    a.length = 0;
+    b.length = 0;
+    addEvent(&a, BEAT + 2, 0, STEP_R);
+    addEvent(&b, BEAT + 2, 1, STEP_U);
+
+    n = interleave(&a, &b, merged, 1);
+    freshPlayers(players);
+    judgeStream(players, 2, merged, n, STEP_U);
+    CHECK(players[0].result == 'm' && players[0].strike == 1, "player 1: '%c', %u strikes", players[0].result, players[0].strike);
+    CHECK(players[1].result == 'h' && players[1].strike == 0, "player 2: '%c', %u strikes", players[1].result, players[1].strike);
+
+    // Step D: player 1 right panel but far too late, player 2 lets go of an old hold first, then hits on time
+    a.length = 0;
+    b.length = 0;
+    addEvent(&a, BEAT + OFFSET + JUDGE_WINDOW + 1, 0, STEP_D);
+    addEvent(&b, BEAT + 1, 1, 0);
+    addEvent(&b, BEAT + 5, 1, STEP_D);
+
+    n = interleave(&a, &b, merged, 0);
+    freshPlayers(players);
+    judgeStream(players, 2, merged, n, STEP_D);
+    CHECK(players[0].result == 'm', "player 1 late press got '%c'", players[0].result);
+    CHECK(players[1].result == 'h', "player 2 got '%c' after releasing an old hold", players[1].result);
+
+    printf("ok   interleaved traces: jump, wrong panel, late press, stale release\n");
+}
+
+
+static void testMaskCompare(void)
+{
+    static const struct
+    {
+        unsigned char chord;
+        unsigned char step;
+        char result;
+    } cases[] = {
+        { STEP_U, STEP_U, 'h' },
+        { STEP_L, STEP_U, 'm' },
+        { 0, STEP_U, 'm' },                                 // nothing pressed in time
+        { STEP_U | STEP_L, STEP_U | STEP_L, 'h' },
+        { STEP_U, STEP_U | STEP_L, 'm' },                   // half a jump
+        { STEP_U | STEP_L, STEP_U, 'm' },                   // diagonal on a single arrow
+        { STEP_U | STEP_L | STEP_R, STEP_U | STEP_L, 'm' }, // extra panel on a jump
+        { STEP_L | STEP_R, STEP_L | STEP_R, 'h' },
+    };
+    Player p;
+    unsigned int i;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        memset(&p, 0, sizeof(p));
+        p.endSong = 'p';
+        judgeStep(&p, cases[i].chord, cases[i].step);
+        CHECK(p.result == cases[i].result, "chord %#x on step %#x got '%c'", cases[i].chord, cases[i].step, p.result);
+        CHECK(p.strike == (cases[i].result == 'm'), "chord %#x on step %#x left %u strikes", cases[i].chord, cases[i].step, p.strike);
+    }
+
+    // Third miss knocks the player out
+    memset(&p, 0, sizeof(p));
+    p.endSong = 'p';
+    judgeStep(&p, STEP_L, STEP_R);
+    judgeStep(&p, STEP_L, STEP_R);
+    CHECK(p.endSong == 'p', "knocked out after two misses");
+    judgeStep(&p, STEP_L, STEP_R);
+    CHECK(p.endSong == 'l', "still in after three misses");
+
+    printf("ok   chord mask compare and strikes\n");
+}
+
+
+static void testWinner(void)
+{
+    Player players[2];
+    unsigned int beat;
+    int i;
+
+    // Versus song: player 1 misses everything (out on beat 3), player 2 misses beats 5, 10 and 14 -
+    // both end on three strikes, but player 2 lasted longer
+    freshPlayers(players);
+    for (beat = 1; beat <= 20; beat++)
+    {
+        char pending = judgeBegin(players, 2);
+
+        for (i = 0; i < 2; i++)
+        {
+            if (pending & (1 << i))
+            {
+                char miss = (i == 0) || beat == 5 || beat == 10 || beat == 14;
+
+                judgeStep(&players[i], miss ? 0 : STEP_U, STEP_U);
+            }
+        }
+    }
+    CHECK(players[0].endSong == 'l' && players[0].beats == 3, "player 1 '%c' after %u beats",
+          players[0].endSong, players[0].beats);
+    CHECK(players[1].endSong == 'l' && players[1].beats == 14, "player 2 '%c' after %u beats",
+          players[1].endSong, players[1].beats);
+    CHECK(judgeWinner(players) == 1, "later knock-out lost (%d)", judgeWinner(players));
+
+    // Surviving beats fewer strikes
+    freshPlayers(players);
+    players[0].endSong = 'l';
+    players[0].strike = 3;
+    players[0].beats = 20;
+    players[1].endSong = 'w';
+    players[1].strike = 2;
+    players[1].beats = 20;
+    CHECK(judgeWinner(players) == 1, "survivor lost (%d)", judgeWinner(players));
+    players[1].strike = 3;
+    players[0].strike = 0;
+    CHECK(judgeWinner(players) == 1, "knocked-out player with fewer strikes won (%d)", judgeWinner(players));
+
+    // Both made it: strikes break the tie, equal strikes are a draw
+    players[0].endSong = 'w';
+    players[0].strike = 1;
+    players[1].strike = 2;
+    CHECK(judgeWinner(players) == 0, "fewer strikes lost (%d)", judgeWinner(players));
+    players[1].strike = 1;
+    CHECK(judgeWinner(players) == -1, "equal finish not a draw (%d)", judgeWinner(players));
+
+    printf("ok   versus winner: survival, then knock-out beat, then strikes\n");
+}
+
+
+static void testWindowCloses(void)
+{
+    Player players[2];
+    InputEvent hit = {BEAT + 4, 0, STEP_U};
+    InputEvent early = {BEAT + OFFSET - JUDGE_WINDOW - 1, 1, STEP_U};
+    unsigned int now;
+    char pending;
+
+    CHECK(!judgeExpired(BEAT + JUDGE_WINDOW, BEAT, 0), "closed on the last sample of the window");
+    CHECK(judgeExpired(BEAT + JUDGE_WINDOW + 1, BEAT, 0), "still open after the window");
+    CHECK(!judgeExpired(BEAT + JUDGE_CLOSE - 1, BEAT, OFFSET), "closed before JUDGE_CLOSE");
+    CHECK(judgeExpired(BEAT + JUDGE_CLOSE, BEAT, OFFSET), "still open at JUDGE_CLOSE");
+    CHECK(!judgeExpired(2, (unsigned int)-4, OFFSET), "closed right after the tick counter wrapped");
+
+    // Player 1 hits, player 2 only has a press left over from before the window and then never moves:
+    // the same loop as directConfirm must still finish, with player 2 missing
+    freshPlayers(players);
+    pending = judgeBegin(players, 2);
+    CHECK(judgeEvent(players, &pending, &early, STEP_U, BEAT, OFFSET) == 0, "stale press judged");
+    CHECK(players[1].chord == 0, "stale press started a chord");
+
+    for (now = BEAT; pending; now++)
+    {
+        CHECK(now <= BEAT + OFFSET + JUDGE_WINDOW + 1, "beat still open at tick %u", now);
+
+        if (now == hit.time)
+        {
+            judgeEvent(players, &pending, &hit, STEP_U, BEAT, OFFSET);
+        }
+        else if (judgeExpired(now, BEAT, OFFSET))
+        {
+            judgeClose(players, &pending, STEP_U);
+        }
+    }
+
+    CHECK(players[0].result == 'h' && players[0].strike == 0, "player 1 got '%c'", players[0].result);
+    CHECK(players[1].result == 'm' && players[1].strike == 1, "idle player 2 got '%c', %u strikes",
+          players[1].result, players[1].strike);
+
+    printf("ok   window closes on time, idle player misses, stale press ignored\n");
+}
+
+
+// Timer A clock on the board: the beat is 32768 ACLK ticks (WDT), a sample every 3277 (timerA_isr)
+#define ACLK_BEAT 32768UL
+#define ACLK_SAMPLE 3277UL
+
+static void testCloseBeforeNextBeat(void)
+{
+    Player players[2];
+    InputEvent late = {BEAT + JUDGE_CLOSE, 0, STEP_U};
+    char pending;
+    int offset;
+    unsigned long phase;
+
+    // For every offset (unclamped ones too) and every sample/beat phase, an idle player's window must close
+    // with at least one sample period (0.1s) left before the next beat: the miss goes out (~16ms at 115200)
+    // and arrowPrepare builds the next frame in that time, or beatFire finds no frame and drops the beat
+    for (offset = 0; offset <= JUDGE_OFFSET_MAX + 10; offset++)
+    {
+        for (phase = 1; phase <= ACLK_SAMPLE; phase++)      // first sample after the beat, in ticks
+        {
+            unsigned int since = 1;
+            unsigned long closeAt;
+
+            while (!judgeExpired(BEAT + since, BEAT, offset))
+            {
+                since++;
+            }
+
+            closeAt = phase + (since - 1) * ACLK_SAMPLE;
+            CHECK(closeAt + ACLK_SAMPLE <= ACLK_BEAT, "offset %d phase %lu: closes %lu ticks into the beat",
+                  offset, phase, closeAt);
+        }
+    }
+
+    // Right panel stamped on the closing sample is too late, even if the offset's window would still take it
+    freshPlayers(players);
+    pending = judgeBegin(players, 1);
+    judgeEvent(players, &pending, &late, STEP_U, BEAT, OFFSET);
+    CHECK(players[0].result == 'm', "press after the close got '%c'", players[0].result);
+
+    printf("ok   every window closes at least 0.1s before the next beat\n");
+}
+
+
+static void testJudgedPlayerIgnored(void)
+{
+    Player players[2];
+    InputEvent events[3] = { {BEAT + 4, 0, STEP_U}, {BEAT + 5, 0, STEP_R}, {BEAT + 6, 1, STEP_U} };
+    char pending;
+
+    // A second press from an already judged player must not touch either result
+    freshPlayers(players);
+    pending = judgeBegin(players, 2);
+    CHECK(judgeEvent(players, &pending, &events[0], STEP_U, BEAT, OFFSET) == 1, "first press not judged");
+    CHECK(pending == 0x02, "pending %#x after player 1, expected 0x2", pending);
+    CHECK(judgeEvent(players, &pending, &events[1], STEP_U, BEAT, OFFSET) == 0, "second press judged again");
+    CHECK(players[0].result == 'h' && players[0].strike == 0, "player 1 changed to '%c'", players[0].result);
+    CHECK(players[1].result == '_', "player 2 judged by player 1's input");
+    CHECK(judgeEvent(players, &pending, &events[2], STEP_U, BEAT, OFFSET) == 1 && pending == 0, "player 2 not judged");
+
+    // A knocked-out player is never pending and their input is dropped
+    freshPlayers(players);
+    players[0].endSong = 'l';
+    pending = judgeBegin(players, 2);
+    CHECK(pending == 0x02, "pending %#x with player 1 out, expected 0x2", pending);
+    CHECK(judgeEvent(players, &pending, &events[0], STEP_U, BEAT, OFFSET) == 0, "knocked-out player judged");
+    CHECK(players[0].result == '_', "knocked-out player got '%c'", players[0].result);
+
+    // Single player: player 2 is never pending even if their stick is wired up
+    freshPlayers(players);
+    pending = judgeBegin(players, 1);
+    CHECK(pending == 0x01, "pending %#x in single player, expected 0x1", pending);
+
+    printf("ok   judged and knocked-out players ignored\n");
+}
+
+
+static void randomTrace(Trace* t, unsigned char player)
+{
+    static const unsigned char masks[] = { 0, STEP_L, STEP_D, STEP_U, STEP_R, STEP_U | STEP_L, STEP_D | STEP_R, STEP_L | STEP_R };
+    unsigned int time = BEAT - 3;
+    unsigned int i;
+
+    t->length = 1 + rand() % TRACE_MAX;
+    for (i = 0; i < t->length; i++)
+    {
+        time += rand() % 4;
+        t->events[i].time = time;
+        t->events[i].player = player;
+        t->events[i].mask = masks[rand() % 8];
+    }
+}
+
+
+static void testMatchesSolo(void)
+{
+    static const unsigned char steps[] = { STEP_L, STEP_D, STEP_U, STEP_R, STEP_U | STEP_L, STEP_D | STEP_R, STEP_L | STEP_R };
+    int round;
+
+    srand(326);
+    for (round = 0; round < 100000; round++)
+    {
+        Player solo[2], alone[2], versus[2];
+        Trace a, b;
+        InputEvent merged[2 * TRACE_MAX];
+        unsigned char step = steps[rand() % 7];
+        unsigned int n;
+        int i;
+
+        randomTrace(&a, 0);
+        randomTrace(&b, 1);
+
+        // Each player alone (the other one knocked out) ...
+        freshPlayers(solo);
+        solo[1].endSong = 'l';
+        judgeStream(solo, 2, a.events, a.length, step);
+        freshPlayers(alone);
+        alone[0].endSong = 'l';
+        judgeStream(alone, 2, b.events, b.length, step);
+        solo[1] = alone[1];
+
+        // ... must match both of them sharing one interleaved queue
+        n = interleave(&a, &b, merged, (unsigned int)rand());
+        freshPlayers(versus);
+        judgeStream(versus, 2, merged, n, step);
+
+        for (i = 0; i < 2; i++)
+        {
+            CHECK(versus[i].result == solo[i].result && versus[i].strike == solo[i].strike &&
+                  versus[i].chord == solo[i].chord,
+                  "round %d player %d: versus '%c' chord %#x, solo '%c' chord %#x",
+                  round, i + 1, versus[i].result, versus[i].chord, solo[i].result, solo[i].chord);
+        }
+    }
+
+    printf("ok   100000 random trace pairs judged the same in versus as solo\n");
+}
+
+
+int main(void)
+{
+    testMaskCompare();
+    testWinner();
+    testInterleavedTraces();
+    testJudgedPlayerIgnored();
+    testWindowCloses();
+    testCloseBeforeNextBeat();
+    testMatchesSolo();
+
+    if (failures != 0)
+    {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
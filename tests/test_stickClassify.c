@@ -0,0 +1,142 @@
+/*------------------------------------------------------------------------------
+ * File:        test_stickClassify.c
+ * Description: Host test for the thumbstick panel classifier.
+ *              1) Fixed readings: the original single-panel zones, diagonals,
+ *                 an UP push drifting sideways, and per-axis hysteresis.
+ *              2) Every reading on a 1% grid against every legal previous mask:
+ *                 no opposing panels, the old single-panel zones always win,
+ *                 and a stick held still never changes its mask twice.
+ *----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+
+#include "gameLogic.h"
+#include "check.h"
+
+
+// Every mask one stick can produce: rest, four panels, four diagonals
+static const unsigned char legalMasks[] = { 0, STEP_L, STEP_D, STEP_U, STEP_R,
+                                            STEP_U | STEP_L, STEP_U | STEP_R, STEP_D | STEP_L, STEP_D | STEP_R };
+#define LEGAL_COUNT (sizeof(legalMasks) / sizeof(legalMasks[0]))
+
+
+static unsigned char classify(unsigned int xPer, unsigned int yPer, unsigned char prev)
+{
+    return stickClassify(ADC_PER(xPer), ADC_PER(yPer), prev);
+}
+
+
+static void expect(unsigned int xPer, unsigned int yPer, unsigned char prev, unsigned char want, int line)
+{
+    unsigned char got = classify(xPer, yPer, prev);
+
+    if (got != want)
+    {
+        printf("FAIL %s:%d: x=%u%% y=%u%% prev %#x -> %#x, expected %#x\n", __FILE__, line, xPer, yPer, prev, got, want);
+        failures++;
+    }
+}
+
+#define EXPECT(x, y, prev, want) expect((x), (y), (prev), (want), __LINE__)
+
+
+static void testFixedReadings(void)
+{
+    int before = failures;
+
+    // Center and the original single-panel zones (<= 15% / >= 85%, other axis 35-65%)
+    EXPECT(50, 50, STEP_U | STEP_L, 0);
+    EXPECT(50, 10, 0, STEP_U);
+    EXPECT(50, 90, 0, STEP_D);
+    EXPECT(10, 50, 0, STEP_L);
+    EXPECT(90, 50, 0, STEP_R);
+    EXPECT(35, 15, 0, STEP_U);
+    EXPECT(65, 0, 0, STEP_U);
+    EXPECT(15, 65, 0, STEP_L);
+
+    // Outside the old zones nothing new is pressed: x=18% is not LEFT any more than it used to be
+    EXPECT(18, 50, 0, 0);
+    EXPECT(50, 20, 0, 0);
+    EXPECT(30, 10, 0, 0);
+
+    // ...but a panel already held stays held there (hysteresis)
+    EXPECT(18, 50, STEP_L, STEP_L);
+    EXPECT(50, 38, STEP_U, STEP_U);
+    EXPECT(50, 45, STEP_U, 0);
+    EXPECT(70, 50, STEP_L, 0);
+
+    // An UP push drifting sideways stays UP, even past x=20%
+    EXPECT(19, 0, STEP_U, STEP_U);
+    EXPECT(18, 12, STEP_U, STEP_U);
+    EXPECT(16, 16, STEP_U, STEP_U);
+    EXPECT(82, 10, STEP_U, STEP_U);
+
+    // A deliberate push into the corner still makes the diagonal
+    EXPECT(12, 12, STEP_U, STEP_U | STEP_L);
+    EXPECT(20, 20, 0, STEP_U | STEP_L);
+    EXPECT(80, 80, 0, STEP_D | STEP_R);
+    EXPECT(22, 80, 0, STEP_D | STEP_L);
+    EXPECT(85, 15, 0, STEP_U | STEP_R);
+
+    // A held diagonal wobbling around its corner doesn't bounce back to a single panel
+    EXPECT(25, 5, STEP_U | STEP_L, STEP_U | STEP_L);
+    EXPECT(5, 25, STEP_U | STEP_L, STEP_U | STEP_L);
+    EXPECT(30, 30, STEP_U | STEP_L, STEP_U | STEP_L);
+
+    // ...and only drops to one once that panel's own zone is reached
+    EXPECT(50, 10, STEP_U | STEP_L, STEP_U);
+    EXPECT(45, 25, STEP_U | STEP_L, STEP_U);
+
+    if (failures == before)
+    {
+        printf("ok   fixed readings: single panels, drift, diagonals, hysteresis\n");
+    }
+}
+
+
+static void testGrid(void)
+{
+    unsigned int x, y, k;
+    unsigned int changes = 0;
+
+    for (x = 0; x <= 100; x++)
+    {
+        for (y = 0; y <= 100; y++)
+        {
+            for (k = 0; k < LEGAL_COUNT; k++)
+            {
+                unsigned char prev = legalMasks[k];
+                unsigned char mask = classify(x, y, prev);
+                unsigned char again = classify(x, y, mask);
+                char singleZone = (y >= 35 && y <= 65 && (x <= 15 || x >= 85)) ||
+                                  (x >= 35 && x <= 65 && (y <= 15 || y >= 85));
+
+                CHECK((mask & (STEP_L | STEP_R)) != (STEP_L | STEP_R) && (mask & (STEP_U | STEP_D)) != (STEP_U | STEP_D),
+                      "x=%u%% y=%u%% prev %#x -> opposing panels %#x", x, y, prev, mask);
+                CHECK(!singleZone || mask == classify(x, y, 0),
+                      "x=%u%% y=%u%% prev %#x -> %#x inside a single-panel zone", x, y, prev, mask);
+                CHECK(again == mask,
+                      "x=%u%% y=%u%% prev %#x -> %#x then %#x with the stick held still", x, y, prev, mask, again);
+
+                changes += (mask != prev);
+            }
+        }
+    }
+
+    printf("ok   %u grid readings x %u previous masks stable (%u mask changes)\n", 101 * 101, (unsigned int)LEGAL_COUNT, changes);
+}
+
+
+int main(void)
+{
+    testFixedReadings();
+    testGrid();
+
+    if (failures != 0)
+    {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,466 @@
+/*------------------------------------------------------------------------------
+ * File:        test_wire.c
+ * Description: Host test for the terminal wire encoder.
+ *              A small ECMA-48 terminal model (CR, LF, CUU/CUD/CUF/CUB, REP,
+ *              CUP, ED, EL) renders every asset raw and encoded; both must
+ *              leave the exact same screen and cursor. Also checks that the
+ *              checked-in symbolsWire.h still matches the encoder, that the
+ *              versus-mode side-by-side lines survive trimming and encoding,
+ *              and prints the bytes saved per asset and for the whole menu.
+ *
+ *              ./test_wire --print   writes a fresh symbolsWire.h to stdout
+ *              (make -C tests wire-table does that into the repo root).
+ *----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wire.h"
+#include "symbols.h"
+#include "symbolsWire.h"
+#include "check.h"
+
+#define ROWS 48
+#define COLS 128
+#define TEXT_MAX 4096
+
+
+// Terminal Model ----------------------
+typedef struct
+{
+    char cells[ROWS][COLS];
+    int row, col;
+    char last;                                              // last graphic character printed (what REP repeats)
+    int unsupported;                                        // escape sequences the model doesn't know
+} Screen;
+
+
+static void screenReset(Screen* s)
+{
+    memset(s->cells, ' ', sizeof(s->cells));
+    s->row = 0;
+    s->col = 0;
+    s->last = ' ';
+    s->unsupported = 0;
+}
+
+
+static int clamp(int v, int lo, int hi)
+{
+    return (v < lo) ? lo : (v > hi) ? hi : v;
+}
+
+
+static void screenPut(Screen* s, char c)
+{
+    s->cells[s->row][s->col] = c;
+    s->col = clamp(s->col + 1, 0, COLS - 1);
+    s->last = c;
+}
+
+
+static void screenFeed(Screen* s, const char* bytes, unsigned int n)
+{
+    unsigned int i = 0;
+
+    while (i < n)
+    {
+        char c = bytes[i++];
+
+        if (c == '\033' && i < n && bytes[i] == '[')
+        {
+            int param[2] = { -1, -1 };
+            int count = 0;
+            char final = 0;
+            int k;
+
+            for (i++; i < n; i++)
+            {
+                if (bytes[i] >= '0' && bytes[i] <= '9')
+                {
+                    param[count] = ((param[count] < 0) ? 0 : param[count] * 10) + (bytes[i] - '0');
+                }
+                else if (bytes[i] == ';' && count == 0)
+                {
+                    count = 1;
+                }
+                else
+                {
+                    final = bytes[i++];
+                    break;
+                }
+            }
+
+            int p = (param[0] < 0) ? 1 : param[0];          // missing parameters default to 1 (0 for ED/EL)
+
+            switch (final)
+            {
+                case 'A': s->row = clamp(s->row - p, 0, ROWS - 1); break;
+                case 'B': s->row = clamp(s->row + p, 0, ROWS - 1); break;
+                case 'C': s->col = clamp(s->col + p, 0, COLS - 1); break;
+                case 'D': s->col = clamp(s->col - p, 0, COLS - 1); break;
+                case 'b':
+                    for (k = 0; k < p; k++)
+                    {
+                        screenPut(s, s->last);
+                    }
+                    break;
+                case 'H':
+                    s->row = clamp(p - 1, 0, ROWS - 1);
+                    s->col = clamp(((param[1] < 0) ? 1 : param[1]) - 1, 0, COLS - 1);
+                    break;
+                case 'J':
+                    if (param[0] == 2)
+                    {
+                        memset(s->cells, ' ', sizeof(s->cells));
+                    }
+                    else
+                    {
+                        memset(&s->cells[s->row][s->col], ' ', (ROWS - s->row) * COLS - s->col);
+                    }
+                    break;
+                case 'K':
+                    memset(&s->cells[s->row][s->col], ' ', COLS - s->col);
+                    break;
+                default:
+                    s->unsupported++;
+                    break;
+            }
+        }
+        else if (c == '\r')
+        {
+            s->col = 0;
+        }
+        else if (c == '\n')
+        {
+            s->row = clamp(s->row + 1, 0, ROWS - 1);       // plain line feed, the column stays put
+        }
+        else if (c >= ' ' && c <= '~')
+        {
+            screenPut(s, c);
+        }
+    }
+}
+
+
+static char screensMatch(const Screen* a, const Screen* b)
+{
+    return memcmp(a->cells, b->cells, sizeof(a->cells)) == 0 && a->row == b->row && a->col == b->col &&
+           a->unsupported == 0 && b->unsupported == 0;
+}
+
+
+// Helpers -----------------------------
+static unsigned int encode(const char* raw, char* out)
+{
+    unsigned int used;
+    unsigned int n = 0;
+
+    while (*raw != 0)
+    {
+        n += wireToken(raw, &used, out + n);
+        raw += used;
+    }
+    out[n] = 0;
+
+    return n;
+}
+
+
+static char rendersSame(const char* raw, const char* wire, unsigned int wireLen)
+{
+    static Screen a, b;
+
+    screenReset(&a);
+    screenReset(&b);
+    screenFeed(&a, raw, strlen(raw));
+    screenFeed(&b, wire, wireLen);
+
+    return screensMatch(&a, &b);
+}
+
+
+static void buildMenu(char* out)
+{
+    // Exactly what modeSelect() used to send string by string
+    const char* parts[] = { "\033[100A", "\033[2J",
+                            lineReset, bar, lineReset, lineReset, title, lineReset, lineReset, bar, lineReset, lineReset,
+                            calibChoice, lineReset, modeChoice, lineReset, benchChoice, lineReset, lineReset,
+                            bar, lineReset };
+    unsigned int i;
+
+    out[0] = 0;
+    for (i = 0; i < sizeof(parts) / sizeof(parts[0]); i++)
+    {
+        strcat(out, parts[i]);
+    }
+}
+
+
+typedef struct
+{
+    const char* name;
+    const char* raw;
+    const char* wire;                                       // checked-in symbolsWire.h entry
+    const char* group;                                      // comment heading in symbolsWire.h
+} Asset;
+
+static char menuRaw[TEXT_MAX];
+
+static const Asset assets[] = {
+    { "bar",         bar,         barWire,         "Menu" },
+    { "title",       title,       titleWire,       "Menu" },
+    { "chooseInstr", chooseInstr, chooseInstrWire, "Menu" },
+    { "calibChoice", calibChoice, calibChoiceWire, "Menu" },
+    { "modeChoice",  modeChoice,  modeChoiceWire,  "Menu" },
+    { "benchChoice", benchChoice, benchChoiceWire, "Menu" },
+    { "menu",        menuRaw,     menuWire,        "Menu" },
+    { "miss",        miss,        missWire,        "Hits/Misses" },
+    { "correct",     correct,     correctWire,     "Hits/Misses" },
+    { "up",          up,          upWire,          "Arrows" },
+    { "down",        down,        downWire,        "Arrows" },
+    { "left",        left,        leftWire,        "Arrows" },
+    { "right",       right,       rightWire,       "Arrows" },
+};
+#define ASSET_COUNT (sizeof(assets) / sizeof(assets[0]))
+
+
+// Tests -------------------------------
+static void testAssets(void)
+{
+    static char wire[TEXT_MAX];
+    unsigned long rawTotal = 0, wireTotal = 0;
+    unsigned int i;
+
+    for (i = 0; i < ASSET_COUNT; i++)
+    {
+        unsigned int raw = strlen(assets[i].raw);
+        unsigned int n = encode(assets[i].raw, wire);
+
+        CHECK(rendersSame(assets[i].raw, wire, n), "%s renders differently once encoded", assets[i].name);
+        CHECK(n == wireLength(assets[i].raw), "%s: wireLength %u, encoder wrote %u", assets[i].name, wireLength(assets[i].raw), n);
+        CHECK(strcmp(wire, assets[i].wire) == 0, "%s: symbolsWire.h is stale, run make -C tests wire-table", assets[i].name);
+
+        printf("     %-12s %4u -> %4u bytes (%.1fx)\n", assets[i].name, raw, n, (double)raw / n);
+        if (strcmp(assets[i].name, "menu") != 0)
+        {
+            rawTotal += raw;
+            wireTotal += n;
+        }
+    }
+
+    printf("ok   %u assets render the same and match symbolsWire.h, %lu -> %lu bytes (%.1fx)\n",
+           (unsigned int)ASSET_COUNT, rawTotal, wireTotal, (double)rawTotal / wireTotal);
+}
+
+
+static void testColumns(void)
+{
+    // Every pair versus mode can draw: jump glyphs side by side, hit/miss results, a knocked-out player
+    const char* art[] = { up, down, left, right, correct, miss, "" };
+    static char raw[TEXT_MAX], wire[TEXT_MAX];
+    unsigned long rawTotal = 0, wireTotal = 0;
+    unsigned int a, b;
+
+    for (a = 0; a < sizeof(art) / sizeof(art[0]); a++)
+    {
+        for (b = 0; b < sizeof(art) / sizeof(art[0]); b++)
+        {
+            const char* l = art[a];
+            const char* r = art[b];
+            const char* lRef = art[a];
+            const char* rRef = art[b];
+            unsigned int rawLen = 0, wireLen = 0;
+
+            while (*l != 0 || *r != 0)
+            {
+                char line[LINE_SIZE + 1];
+                int col;
+
+                // Reference: the untrimmed, unencoded line
+                for (col = 0; *lRef != 0 && *lRef != '\n' && *lRef != '\r' && col < COLUMN_WIDTH; col++)
+                {
+                    raw[rawLen++] = *lRef++;
+                }
+                for (; col < COLUMN_WIDTH; col++)
+                {
+                    raw[rawLen++] = ' ';
+                }
+                while (*rRef != 0 && *rRef != '\n' && *rRef != '\r')
+                {
+                    raw[rawLen++] = *rRef++;
+                }
+                while (*lRef == '\n' || *lRef == '\r')
+                {
+                    lRef++;
+                }
+                while (*rRef == '\n' || *rRef == '\r')
+                {
+                    rRef++;
+                }
+                memcpy(&raw[rawLen], lineReset, 2);
+                rawLen += 2;
+
+                // What frameAppendColumns() / UART_sendColumns() send
+                columnLine(&l, &r, line);
+                wireLen += encode(line, &wire[wireLen]);
+                wireLen += encode(lineReset, &wire[wireLen]);
+            }
+            raw[rawLen] = 0;
+
+            CHECK(rendersSame(raw, wire, wireLen), "columns %u/%u render differently", a, b);
+            rawTotal += rawLen;
+            wireTotal += wireLen;
+        }
+    }
+
+    printf("ok   49 side-by-side pairs render the same, %lu -> %lu bytes\n", rawTotal, wireTotal);
+}
+
+
+static void appendRandomLine(char* text, char lastLine)
+{
+    static const char alphabet[] = "  ----==##||//\\\\ab";
+    unsigned int len = strlen(text);
+    unsigned int col = 0;
+
+    // Runs of one character (long ones included), never past the right edge
+    while (col < 100 && rand() % 8 != 0)
+    {
+        char c = alphabet[rand() % (sizeof(alphabet) - 1)];
+        unsigned int run = (rand() % 4 == 0) ? 1 + rand() % 40 : 1 + rand() % 3;
+
+        for (; run > 0 && col < 100; run--, col++)
+        {
+            text[len++] = c;
+        }
+    }
+
+    switch (rand() % (lastLine ? 4 : 3))
+    {
+        case 0: memcpy(&text[len], "\r\n", 2); len += 2; break;
+        case 1: memcpy(&text[len], "\n\r", 2); len += 2; break;
+        case 2: memcpy(&text[len], "\033[100A\033[2J\r\n", 13); len += 13; break;
+        default: break;                                     // string ends mid-line, trailing spaces must stay
+    }
+    text[len] = 0;
+}
+
+
+static void testRandomText(void)
+{
+    static char raw[TEXT_MAX], wire[TEXT_MAX];
+    unsigned long rawTotal = 0, wireTotal = 0;
+    int round;
+
+    srand(325);
+    for (round = 0; round < 20000; round++)
+    {
+        int lines = 1 + rand() % 30;                        // stays inside the model's rows, so nothing is drawn over
+        unsigned int n;
+
+        raw[0] = 0;
+        while (lines-- > 0)
+        {
+            appendRandomLine(raw, lines == 0);
+        }
+
+        n = encode(raw, wire);
+        CHECK(rendersSame(raw, wire, n), "round %d renders differently: \"%s\"", round, raw);
+        rawTotal += strlen(raw);
+        wireTotal += n;
+    }
+
+    printf("ok   20000 random screens render the same, %lu -> %lu bytes\n", rawTotal, wireTotal);
+}
+
+
+// symbolsWire.h Generator --------------
+static void printChar(char c)
+{
+    switch (c)
+    {
+        case '\\':   printf("\\\\"); break;
+        case '"':    printf("\\\""); break;
+        case '\033': printf("\\033"); break;
+        case '\r':   printf("\\r"); break;
+        case '\n':   printf("\\n"); break;
+        default:     putchar(c); break;
+    }
+}
+
+
+static void printLiteral(const char* s)
+{
+    // One source line per screen line, like symbols.h
+    printf("\"");
+    while (*s != 0)
+    {
+        printChar(*s);
+        if ((s[0] == '\n' && s[1] == '\r') || (s[0] == '\r' && s[1] == '\n'))
+        {
+            printChar(*++s);
+            if (s[1] != 0)
+            {
+                printf("\"\n%31s\"", "");
+            }
+        }
+        s++;
+    }
+    printf("\"");
+}
+
+
+static void printTable(void)
+{
+    static char wire[TEXT_MAX];
+    const char* group = "";
+    unsigned int i;
+
+    printf("/* Pre-encoded wire forms of the static strings in symbols.h (encoding: see wire.c) */\n");
+    printf("/* Sent byte for byte with UART_sendRaw()/frameAppendRaw(), nothing is encoded at run time */\n");
+    printf("/* Generated - do not edit: \"make -C tests wire-table\" rewrites this file from symbols.h, */\n");
+    printf("/* and tests/test_wire fails as soon as the two drift apart */\n");
+
+    for (i = 0; i < ASSET_COUNT; i++)
+    {
+        char name[32];
+
+        if (strcmp(group, assets[i].group) != 0)
+        {
+            group = assets[i].group;
+            printf("\n\n// %s\n", group);
+        }
+
+        encode(assets[i].raw, wire);
+        snprintf(name, sizeof(name), "%sWire[]", assets[i].name);
+        printf("const char %-18s= ", name);
+        printLiteral(wire);
+        printf(";\n");
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    buildMenu(menuRaw);
+
+    if (argc > 1 && strcmp(argv[1], "--print") == 0)
+    {
+        printTable();
+        return 0;
+    }
+
+    testAssets();
+    testColumns();
+    testRandomText();
+
+    if (failures != 0)
+    {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
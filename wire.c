@@ -0,0 +1,169 @@
+/*------------------------------------------------------------------------------
+ * File:        wire.c
+ * Description: Terminal wire encoding (ECMA-48 REP / CUF). Everything sent to
+ *              the terminal goes through here, either live (UART_sendString,
+ *              frameAppend) or ahead of time (symbolsWire.h, checked by
+ *              tests/test_wire.c), plus the side-by-side line layout used for
+ *              versus mode. No hardware access, builds on the host too.
+ *----------------------------------------------------------------------------*/
+
+#include "wire.h"
+
+
+unsigned char wireToken(const char* in, unsigned int* used, char* out)
+{
+    /* Wire Encoder - turns the next run of "in" into the fewest bytes the terminal renders the same:
+    *
+    *   run of spaces      ->  CSI n C      (cursor forward, screen is always blank where we draw)
+    *   spaces ending a line -> nothing     (only before \r or \n\r, where the column is reset anyway)
+    *   run of anything    ->  c CSI n-1 b  (REP, repeat the character just printed)
+    *   escape sequences   ->  copied as-is, so their digits are never touched
+    *
+    * Returns the number of bytes written to "out", "*used" gets the number of input bytes eaten.
+    */
+
+    char c = in[0];
+    unsigned int n = 1;
+    unsigned char len = 0;
+
+    // Escape sequence passthrough (ESC [ params final)
+    if (c == '\033')
+    {
+        out[len++] = in[n - 1];
+        if (in[n] == '[')
+        {
+            out[len++] = in[n++];
+            while (in[n] != 0 && len < WIRE_TOKEN_MAX)
+            {
+                out[len++] = in[n];
+                if (in[n++] >= 0x40)                        // final byte ends the sequence
+                {
+                    break;
+                }
+            }
+        }
+        *used = n;
+        return len;
+    }
+
+    // Measure the run
+    while (in[n] == c && n < WIRE_RUN_MAX)
+    {
+        n++;
+    }
+
+    // Trailing spaces right before a carriage return are never seen, drop them
+    if (c == ' ' && (in[n] == '\r' || (in[n] == '\n' && in[n + 1] == '\r')))
+    {
+        *used = n;
+        return 0;
+    }
+
+    unsigned int count = (c == ' ') ? n : n - 1;            // CUF skips every space, REP repeats all but the first
+    unsigned char digits = (count >= 100) ? 3 : (count >= 10) ? 2 : 1;
+    unsigned char packed = (c == ' ') ? (3 + digits) : (1 + 3 + digits);
+
+    if (c >= ' ' && c <= '~' && packed < n)                 // printable and actually shorter
+    {
+        if (c != ' ')
+        {
+            out[len++] = c;
+        }
+        out[len++] = '\033';
+        out[len++] = '[';
+        if (digits == 3)
+        {
+            out[len++] = '0' + count / 100;
+        }
+        if (digits >= 2)
+        {
+            out[len++] = '0' + (count / 10) % 10;
+        }
+        out[len++] = '0' + count % 10;
+        out[len++] = (c == ' ') ? 'C' : 'b';
+
+        *used = n;
+        return len;
+    }
+
+    // Not worth it - send the run raw (short by construction, bounded for control characters)
+    if (n > WIRE_TOKEN_MAX)
+    {
+        n = WIRE_TOKEN_MAX;
+    }
+    for (len = 0; len < n; len++)
+    {
+        out[len] = c;
+    }
+
+    *used = n;
+    return len;
+}
+
+
+unsigned int wireLength(const char* string)
+{
+    // Bytes UART_sendString() will actually put on the wire for "string"
+    char token[WIRE_TOKEN_MAX];
+    unsigned int used;
+    unsigned int total = 0;
+
+    while (*string != 0)
+    {
+        total += wireToken(string, &used, token);
+        string += used;
+    }
+
+    return total;
+}
+
+
+void columnLine(const char** leftStr, const char** rightStr, char* line)
+{
+    // Builds the next side-by-side line into "line" (no line ending) and moves both strings past it
+    const char* l = *leftStr;
+    const char* r = *rightStr;
+    int col = 0;
+
+    while (*l != 0 && *l != '\n' && *l != '\r' && col < COLUMN_WIDTH)     // left column line
+    {
+        line[col++] = *l++;
+    }
+    while (*l != 0 && *l != '\n' && *l != '\r')                           // (anything too wide is dropped)
+    {
+        l++;
+    }
+    while (*l == '\n' || *l == '\r')                                      // skip its line ending
+    {
+        l++;
+    }
+
+    while (col < COLUMN_WIDTH)                                             // pad out to the right column
+    {
+        line[col++] = ' ';
+    }
+
+    while (*r != 0 && *r != '\n' && *r != '\r' && col < LINE_SIZE)        // right column line
+    {
+        line[col++] = *r++;
+    }
+    while (*r != 0 && *r != '\n' && *r != '\r')
+    {
+        r++;
+    }
+    while (*r == '\n' || *r == '\r')
+    {
+        r++;
+    }
+
+    while (col > 0 && line[col - 1] == ' ')                              // a line ending always follows, trailing blanks are never seen
+    {
+        col--;
+    }
+
+    line[col] = 0;
+    *leftStr = l;
+    *rightStr = r;
+
+    return;
+}
@@ -0,0 +1,19 @@
+/* Wire Encoder - shortest byte sequence that renders the same on a blank terminal */
+/* No hardware access in here, so the same code builds for the board and for the host tests */
+
+#ifndef WIRE_H
+#define WIRE_H
+
+#define WIRE_TOKEN_MAX 8                                    // wire encoder: most bytes one token can turn into
+#define WIRE_RUN_MAX 999                                    // wire encoder: longest run folded into one sequence
+#define COLUMN_WIDTH 36                                     // half of a bar's width, used for side-by-side output
+#define LINE_SIZE 72                                        // one side-by-side line: padded left column + right column
+
+
+unsigned char wireToken(const char* in, unsigned int* used, char* out);
+                                                            // encode the next run of "in" into "out": returns bytes written (may be 0)
+unsigned int wireLength(const char* string);                // bytes UART_sendString() puts on the wire for "string"
+void columnLine(const char** leftStr, const char** rightStr, char* line);
+                                                            // next side-by-side line of two strings into "line" (LINE_SIZE + 1)
+
+#endif